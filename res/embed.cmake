@@ -0,0 +1,39 @@
+# Writes OUTPUT, a translation unit embedding INPUT as the resource NAME.
+# Optionally gzips the data first and embeds it with .incbin when INCBIN is set.
+cmake_minimum_required(VERSION 3.20)
+if (COMPRESS)
+	file(ARCHIVE_CREATE OUTPUT "${OUTPUT}.gz" PATHS "${INPUT}" FORMAT raw COMPRESSION GZip)
+	set(INPUT "${OUTPUT}.gz")
+endif()
+file(SIZE "${INPUT}" blob_size)
+file(WRITE "${OUTPUT}" "// Resource ${NAME}\n")
+file(APPEND "${OUTPUT}" "#include \"resources.h\"\n")
+file(APPEND "${OUTPUT}" "\n")
+if (blob_size EQUAL 0)
+	file(APPEND "${OUTPUT}" "static const unsigned char *${NAME}_blob = nullptr;\n")
+	set(blob_length "0")
+elseif (INCBIN)
+	file(APPEND "${OUTPUT}" "extern \"C\" const unsigned char ${NAME}_blob[];\n")
+	file(APPEND "${OUTPUT}" "extern \"C\" const unsigned char ${NAME}_blob_end[];\n")
+	file(APPEND "${OUTPUT}" "__asm__(\".pushsection .rodata\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \".global ${NAME}_blob\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \".global ${NAME}_blob_end\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \".balign 16\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \"${NAME}_blob:\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \".incbin \\\"${INPUT}\\\"\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \"${NAME}_blob_end:\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \".byte 0\\n\"\n")
+	file(APPEND "${OUTPUT}" "        \".popsection\\n\");\n")
+	set(blob_length "int(${NAME}_blob_end - ${NAME}_blob)")
+else()
+	file(READ "${INPUT}" hex_content HEX)
+	string(REGEX REPLACE "([A-Fa-f0-9][A-Fa-f0-9])" "0x\\1," output_hex "${hex_content}")
+	file(APPEND "${OUTPUT}" "static const unsigned char ${NAME}_blob[${blob_size}] = {\n${output_hex}\n};\n")
+	set(blob_length "${blob_size}")
+endif()
+file(APPEND "${OUTPUT}" "\n")
+file(APPEND "${OUTPUT}" "const resource &${NAME}()\n")
+file(APPEND "${OUTPUT}" "{\n")
+file(APPEND "${OUTPUT}" "  static const resource instance = load_resource(${NAME}_blob, ${blob_length});\n")
+file(APPEND "${OUTPUT}" "  return instance;\n")
+file(APPEND "${OUTPUT}" "}\n")
@@ -0,0 +1,34 @@
+#include "resource.h"
+
+#ifdef COMPRESSED_RESOURCES
+#include <stdexcept>
+
+#include <zlib.h>
+#endif
+
+resource load_resource(const unsigned char *data, int size)
+{
+#ifdef COMPRESSED_RESOURCES
+  uLong raw_size = data[size - 4] | data[size - 3] << 8 | data[size - 2] << 16 |
+                   uLong(data[size - 1]) << 24;
+  auto raw = new unsigned char[raw_size];
+  z_stream stream{};
+  stream.next_in = const_cast<Bytef *>(data);
+  stream.avail_in = size;
+  stream.next_out = raw;
+  stream.avail_out = raw_size;
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+  {
+    throw std::runtime_error("inflateInit2");
+  }
+  auto result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  if (result != Z_STREAM_END)
+  {
+    throw std::runtime_error("inflate");
+  }
+  return {raw, int(raw_size)};
+#else
+  return {data, size};
+#endif
+}
@@ -0,0 +1,12 @@
+#ifndef RES_RESOURCE_H
+#define RES_RESOURCE_H
+
+struct resource
+{
+  const unsigned char *data;
+  int size;
+};
+
+resource load_resource(const unsigned char *data, int size);
+
+#endif // RES_RESOURCE_H
@@ -0,0 +1,113 @@
+#include "alarm_scheduler.h"
+
+#include <iterator>
+
+namespace
+{
+  std::int64_t days_from_civil(std::int64_t year, int month, int day)
+  {
+    year -= month <= 2;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const std::int64_t year_of_era = year - era * 400;
+    const std::int64_t day_of_year =
+        (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const std::int64_t day_of_era = year_of_era * 365 + year_of_era / 4 -
+                                    year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+  }
+
+  std::size_t week_minute(std::int64_t minute)
+  {
+    auto day = minute / (24 * 60) - (minute % (24 * 60) < 0 ? 1 : 0);
+    auto weekday = ((day + 4) % 7 + 7) % 7;
+    return weekday * 24 * 60 + (minute - day * 24 * 60);
+  }
+}
+
+alarm_scheduler::alarm_scheduler()
+    : processed_{std::numeric_limits<std::int64_t>::min()}
+{
+}
+
+alarm_scheduler::~alarm_scheduler() {}
+
+void alarm_scheduler::clear() { alarms_.clear(); }
+
+void alarm_scheduler::add(std::size_t alarm) { alarms_.insert(alarm); }
+
+void alarm_scheduler::remove(std::size_t alarm) { alarms_.erase(alarm); }
+
+std::size_t alarm_scheduler::next(std::int64_t minute) const
+{
+  auto alarm = alarms_.upper_bound(week_minute(minute));
+  if (alarm == alarms_.end())
+  {
+    alarm = alarms_.begin();
+  }
+  return alarm != alarms_.end() ? *alarm : std::size_t(-1);
+}
+
+std::int64_t alarm_scheduler::lead(std::int64_t minute) const
+{
+  auto alarm = next(minute);
+  if (alarm == std::size_t(-1))
+  {
+    return -1;
+  }
+  auto lead = std::int64_t(alarm) - std::int64_t(week_minute(minute));
+  return lead > 0 ? lead : lead + WEEK_MINUTES;
+}
+
+bool alarm_scheduler::advance(std::int64_t minute, std::size_t &missed,
+                              bool &due)
+{
+  missed = 0;
+  due = false;
+  if (processed_ != std::numeric_limits<std::int64_t>::min())
+  {
+    if (minute <= processed_)
+    {
+      return false;
+    }
+    auto span = minute - processed_ - 1;
+    missed = alarms_.size() * (span / WEEK_MINUTES);
+    auto begin = week_minute(processed_ + 1);
+    auto end = begin + span % WEEK_MINUTES;
+    if (end <= WEEK_MINUTES)
+    {
+      missed += count(begin, end);
+    }
+    else
+    {
+      missed += count(begin, WEEK_MINUTES) + count(0, end - WEEK_MINUTES);
+    }
+  }
+  due = alarms_.count(week_minute(minute)) != 0;
+  processed_ = minute;
+  return true;
+}
+
+void alarm_scheduler::rebase(std::int64_t minute)
+{
+  // After the wall clock steps back, the minutes up to the old processed one
+  // come again; only those already rung before the step are skipped.
+  if (processed_ != std::numeric_limits<std::int64_t>::min() &&
+      processed_ >= minute)
+  {
+    processed_ = minute - 1;
+  }
+}
+
+std::int64_t alarm_scheduler::minute(const std::tm &time)
+{
+  return (days_from_civil(time.tm_year + 1900, time.tm_mon + 1, time.tm_mday) *
+              24 +
+          time.tm_hour) *
+             60 +
+         time.tm_min;
+}
+
+std::size_t alarm_scheduler::count(std::size_t begin, std::size_t end) const
+{
+  return std::distance(alarms_.lower_bound(begin), alarms_.lower_bound(end));
+}
@@ -0,0 +1,33 @@
+#ifndef SRC_ALARM_SCHEDULER_H
+#define SRC_ALARM_SCHEDULER_H
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <set>
+
+#define WEEK_MINUTES (7 * 24 * 60)
+
+class alarm_scheduler
+{
+private:
+  std::set<std::size_t> alarms_;
+  std::int64_t processed_;
+
+public:
+  alarm_scheduler();
+  ~alarm_scheduler();
+  void clear();
+  void add(std::size_t alarm);
+  void remove(std::size_t alarm);
+  std::size_t next(std::int64_t minute) const;
+  std::int64_t lead(std::int64_t minute) const;
+  bool advance(std::int64_t minute, std::size_t &missed, bool &due);
+  void rebase(std::int64_t minute);
+  static std::int64_t minute(const std::tm &time);
+
+private:
+  std::size_t count(std::size_t begin, std::size_t end) const;
+};
+
+#endif // SRC_ALARM_SCHEDULER_H
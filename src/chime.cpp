@@ -1,6 +1,15 @@
 #include "chime.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(COMPACT_WAVES) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(COMPACT_WAVES) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 const float chime::cent_[FREQUENCY_COUNT] = {-24.0f, -12.0f, -9.0f, -4.0f,
                                              0.0f, 7.0f, 12.0f};
@@ -159,9 +168,16 @@ const std::vector<std::pair<float, float>> chime::amplitude_[FREQUENCY_COUNT] =
         },
 };
 
-chime::chime(int pitch)
+chime::chime() : wave_{}, size_{0}, scale_{1.0f} {}
+
+chime::chime(int pitch) : wave_{}, size_{0}, scale_{1.0f}
+{
+  store(synthesize(pitch));
+}
+
+std::vector<float> chime::synthesize(int pitch)
 {
-  float note = 440 + 40 * pitch;
+  float note = BASE_NOTE + PITCH_STEP * pitch;
   int pos_end[FREQUENCY_COUNT];
   int progress[FREQUENCY_COUNT];
   float base[FREQUENCY_COUNT];
@@ -173,10 +189,10 @@ chime::chime(int pitch)
     progress[i] = 0;
     pos_end[i] = 0;
   }
-  wave_.resize(DURATION * SEGMENT_COUNT * SAMPLE_COUNT);
+  std::vector<float> wave(DURATION * SEGMENT_COUNT * SAMPLE_COUNT);
   for (int pos = 0; pos < DURATION * SEGMENT_COUNT * SAMPLE_COUNT; ++pos)
   {
-    wave_[pos] = 0;
+    wave[pos] = 0;
     for (int i = 0; i < FREQUENCY_COUNT; ++i)
     {
       if (pos == pos_end[i])
@@ -191,33 +207,207 @@ chime::chime(int pitch)
                      (DURATION * SEGMENT_COUNT * SAMPLE_COUNT);
         ++progress[i];
       }
-      wave_[pos] += base[i] * std::sin(8.0f * std::atan(1.0f) * frequency[i] *
+      wave[pos] += base[i] * std::sin(8.0f * std::atan(1.0f) * frequency[i] *
                                        pos / (SEGMENT_COUNT * SAMPLE_COUNT));
       base[i] += jump[i];
     }
   }
+  return wave;
+}
+
+chime::chime(const std::vector<float> &wave) : wave_{}, size_{0}, scale_{1.0f}
+{
+  store(wave);
+}
+
+chime::chime(std::shared_ptr<const sample_t> wave, std::size_t size,
+             float scale)
+    : wave_{std::move(wave)},
+      size_{size},
+      scale_{scale}
+{
 }
 
 chime::~chime() {}
 
-bool chime::play(float volume, int &pos, float *buffer, int count)
+const sample_t *chime::data() const { return wave_.get(); }
+
+std::size_t chime::size() const { return size_; }
+
+float chime::scale() const { return scale_; }
+
+std::uint32_t chime::fingerprint()
 {
-  if (pos < 0)
+  // FNV-1a over everything the synthesized waves depend on.
+  std::uint32_t hash = 2166136261u;
+  auto add = [&](const void *data, std::size_t size)
+  {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      hash = (hash ^ static_cast<const unsigned char *>(data)[i]) * 16777619u;
+    }
+  };
+  const std::int32_t format[] = {BASE_NOTE, PITCH_STEP, DURATION,
+                                 SEGMENT_COUNT, SAMPLE_COUNT, FREQUENCY_COUNT,
+                                 std::int32_t(sizeof(sample_t))};
+  add(format, sizeof(format));
+  add(cent_, sizeof(cent_));
+  for (const auto &amplitude : amplitude_)
+  {
+    for (const auto &[time, level] : amplitude)
+    {
+      add(&time, sizeof(time));
+      add(&level, sizeof(level));
+    }
+  }
+  return hash;
+}
+
+void chime::resample(int from, int to)
+{
+  auto source = load();
+  std::vector<float> wave(std::int64_t(source.size()) * to / from);
+  for (std::size_t pos = 0; pos < wave.size(); ++pos)
+  {
+    auto position = std::int64_t(pos) * from;
+    auto index = position / to;
+    auto fraction = float(position % to) / to;
+    auto next = std::min<std::size_t>(index + 1, source.size() - 1);
+    wave[pos] = source[index] + (source[next] - source[index]) * fraction;
+  }
+  store(wave);
+}
+
+bool chime::play(float volume, int pos, float *buffer, int count) const
+{
+  int end = std::min<int>(pos + count, size_);
+  const sample_t *wave = wave_.get() + pos;
+  const float gain = volume * scale_;
+  int i = 0;
+#if defined(COMPACT_WAVES) && defined(__SSE2__)
+  const __m128 factor = _mm_set1_ps(gain);
+  for (; i + 8 <= end - pos; i += 8)
+  {
+    __m128i samples =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(wave + i));
+    __m128 low = _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+    __m128 high = _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+    _mm_storeu_ps(buffer + i,
+                  _mm_add_ps(_mm_loadu_ps(buffer + i), _mm_mul_ps(low, factor)));
+    _mm_storeu_ps(buffer + i + 4, _mm_add_ps(_mm_loadu_ps(buffer + i + 4),
+                                             _mm_mul_ps(high, factor)));
+  }
+#elif defined(COMPACT_WAVES) && defined(__ARM_NEON)
+  const float32x4_t factor = vdupq_n_f32(gain);
+  for (; i + 8 <= end - pos; i += 8)
   {
-    pos += count;
+    int16x8_t samples = vld1q_s16(wave + i);
+    float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+    float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+    vst1q_f32(buffer + i, vmlaq_f32(vld1q_f32(buffer + i), low, factor));
+    vst1q_f32(buffer + i + 4,
+              vmlaq_f32(vld1q_f32(buffer + i + 4), high, factor));
   }
-  else
+#endif
+  for (; i < end - pos; ++i)
   {
-    int done = pos;
-    while (pos < done + count)
+    buffer[i] += gain * wave[i];
+  }
+  return pos + count < int(size_);
+}
+
+chime chime::sequence(const std::vector<NOTE> &notes)
+{
+  // Mixed a block at a time straight into the stored samples, so no float
+  // copy of the whole sequence is made; 16-bit samples take a first pass
+  // for the peak.
+  std::size_t size = 0;
+  for (const auto &note : notes)
+  {
+    size = std::max(size, note.pos + note.voice->size_);
+  }
+  std::shared_ptr<sample_t> samples{new sample_t[size],
+                                    std::default_delete<sample_t[]>()};
+  float block[SAMPLE_COUNT];
+  float scale = 1.0f;
+#ifdef COMPACT_WAVES
+  float peak = 0.0f;
+  for (std::size_t begin = 0; begin < size; begin += SAMPLE_COUNT)
+  {
+    int count = std::min<std::size_t>(SAMPLE_COUNT, size - begin);
+    mix_block(notes, begin, block, count);
+    for (int i = 0; i < count; ++i)
+    {
+      peak = std::max(peak, std::abs(block[i]));
+    }
+  }
+  scale = peak > 0.0f ? peak / 32767.0f : 1.0f;
+#endif
+  for (std::size_t begin = 0; begin < size; begin += SAMPLE_COUNT)
+  {
+    int count = std::min<std::size_t>(SAMPLE_COUNT, size - begin);
+    mix_block(notes, begin, block, count);
+    for (int i = 0; i < count; ++i)
+    {
+#ifdef COMPACT_WAVES
+      samples.get()[begin + i] = sample_t(std::lround(block[i] / scale));
+#else
+      samples.get()[begin + i] = block[i];
+#endif
+    }
+  }
+  return {samples, size, scale};
+}
+
+void chime::store(const std::vector<float> &wave)
+{
+  std::shared_ptr<sample_t> samples{new sample_t[wave.size()],
+                                    std::default_delete<sample_t[]>()};
+#ifdef COMPACT_WAVES
+  float peak = 0.0f;
+  for (const auto sample : wave)
+  {
+    peak = std::max(peak, std::abs(sample));
+  }
+  scale_ = peak > 0.0f ? peak / 32767.0f : 1.0f;
+  for (std::size_t pos = 0; pos < wave.size(); ++pos)
+  {
+    samples.get()[pos] = sample_t(std::lround(wave[pos] / scale_));
+  }
+#else
+  std::memcpy(samples.get(), wave.data(), wave.size() * sizeof(sample_t));
+#endif
+  wave_ = samples;
+  size_ = wave.size();
+}
+
+std::vector<float> chime::load() const
+{
+  std::vector<float> wave(size_, 0.0f);
+  play(1.0f, 0, wave.data(), wave.size());
+  return wave;
+}
+
+void chime::mix_block(const std::vector<NOTE> &notes, std::size_t begin,
+                      float *block, int count)
+{
+  std::fill(block, block + count, 0.0f);
+  for (const auto &note : notes)
+  {
+    if (note.pos >= begin + count || note.pos + note.voice->size_ <= begin)
+    {
+      continue;
+    }
+    if (note.pos >= begin)
     {
-      buffer[pos - done] += volume * wave_[pos];
-      ++pos;
+      int offset = note.pos - begin;
+      note.voice->play(note.volume, 0, block + offset, count - offset);
     }
-    if (pos == DURATION * SEGMENT_COUNT * SAMPLE_COUNT)
+    else
     {
-      return false;
+      note.voice->play(note.volume, begin - note.pos, block, count);
     }
   }
-  return true;
 }
@@ -1,24 +1,60 @@
 #ifndef SRC_CHIME_H
 #define SRC_CHIME_H
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #define SAMPLE_COUNT 1500
 #define SEGMENT_COUNT 32
 #define FREQUENCY_COUNT 7
 #define DURATION 4
+#define BASE_NOTE 440
+#define PITCH_STEP 40
+
+#ifdef COMPACT_WAVES
+typedef std::int16_t sample_t;
+#else
+typedef float sample_t;
+#endif
 
 class chime
 {
+public:
+  struct NOTE
+  {
+    const chime *voice;
+    float volume;
+    std::size_t pos;
+  };
+
 private:
-  std::vector<float> wave_;
+  std::shared_ptr<const sample_t> wave_;
+  std::size_t size_;
+  float scale_;
   static const float cent_[FREQUENCY_COUNT];
   static const std::vector<std::pair<float, float>> amplitude_[FREQUENCY_COUNT];
 
 public:
+  chime();
   chime(int pitch);
+  chime(const std::vector<float> &wave);
+  chime(std::shared_ptr<const sample_t> wave, std::size_t size, float scale);
   ~chime();
-  bool play(float volume, int &pos, float *buffer, int count);
+  const sample_t *data() const;
+  std::size_t size() const;
+  float scale() const;
+  static std::vector<float> synthesize(int pitch);
+  static std::uint32_t fingerprint();
+  void resample(int from, int to);
+  bool play(float volume, int pos, float *buffer, int count) const;
+  static chime sequence(const std::vector<NOTE> &notes);
+
+private:
+  void store(const std::vector<float> &wave);
+  std::vector<float> load() const;
+  static void mix_block(const std::vector<NOTE> &notes, std::size_t begin,
+                        float *block, int count);
 };
 
 #endif // SRC_CHIME_H
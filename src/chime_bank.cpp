@@ -0,0 +1,231 @@
+#include "chime_bank.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  struct HEADER
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t fingerprint;
+    std::uint32_t sample_rate;
+    std::uint32_t sample_size;
+    std::uint32_t count;
+    std::uint32_t length;
+    std::atomic<std::uint32_t> ready;
+    float scale[CHIME_BANK_SIZE];
+  };
+
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                "The ready flag is shared between processes");
+
+  const char MAGIC[8] = {'C', 'L', 'K', 'C', 'H', 'I', 'M', 'E'};
+  const std::size_t DATA_OFFSET = (sizeof(HEADER) + 63) / 64 * 64;
+  const char PREFIX[] = "clock-chimes-";
+  // How long to wait for a creator to lock a bank it has just created.
+  const int ATTEMPTS = 100;
+  const auto RETRY_DELAY = std::chrono::milliseconds(10);
+}
+
+std::vector<chime> chime_bank::load()
+{
+  auto chimes = share();
+  return chimes.empty() ? synthesize() : chimes;
+}
+
+std::vector<chime> chime_bank::synthesize()
+{
+  std::vector<int> sequence(CHIME_BANK_SIZE);
+  std::iota(sequence.begin(), sequence.end(), 0);
+  return std::vector<chime>(sequence.begin(), sequence.end());
+}
+
+#ifndef _WIN32
+std::vector<chime> chime_bank::share()
+{
+  // The name carries the fingerprint of the synthesis parameters, so clocks
+  // of different builds never open each other's bank.
+  char name[64];
+  std::snprintf(name, sizeof(name), "/%s%u-%08x", PREFIX,
+                unsigned(CHIME_BANK_VERSION), unsigned(chime::fingerprint()));
+  for (int attempt = 0; attempt < ATTEMPTS; ++attempt)
+  {
+    auto fd = shm_open(name, O_RDONLY, 0);
+    if (fd >= 0)
+    {
+      // The creator holds an exclusive lock until the bank is complete, and
+      // sizes it only once it holds the lock. An empty bank may just not be
+      // locked yet, so it is waited for rather than removed.
+      flock(fd, LOCK_SH);
+      struct stat status;
+      if (fstat(fd, &status) == 0 && status.st_size == 0)
+      {
+        close(fd);
+        std::this_thread::sleep_for(RETRY_DELAY);
+        continue;
+      }
+      bool stale = false;
+      auto chimes = attach(fd, stale);
+      close(fd);
+      if (!stale)
+      {
+        return chimes;
+      }
+      // Unlocked but never completed: the creator died, so start over.
+      shm_unlink(name);
+      continue;
+    }
+    if (errno != ENOENT)
+    {
+      return {};
+    }
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+      if (errno == EEXIST)
+      {
+        continue;
+      }
+      return {};
+    }
+    flock(fd, LOCK_EX);
+    fchmod(fd, 0644);
+    remove_others(name);
+    auto chimes = synthesize();
+    if (!publish(fd, chimes))
+    {
+      shm_unlink(name);
+      close(fd);
+      return chimes;
+    }
+    bool stale = false;
+    auto shared = attach(fd, stale);
+    close(fd);
+    return shared.empty() ? chimes : shared;
+  }
+  return {};
+}
+
+std::vector<chime> chime_bank::attach(int fd, bool &stale)
+{
+  struct stat status;
+  if (fstat(fd, &status) != 0 || std::size_t(status.st_size) < DATA_OFFSET)
+  {
+    return {};
+  }
+  std::size_t size = status.st_size;
+  auto data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED)
+  {
+    return {};
+  }
+  std::shared_ptr<const void> mapping{
+      data, [size](const void *data)
+      { munmap(const_cast<void *>(data), size); }};
+  auto header = static_cast<const HEADER *>(data);
+  if (header->ready.load(std::memory_order_acquire) == 0)
+  {
+    stale = true;
+    return {};
+  }
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->version != CHIME_BANK_VERSION ||
+      header->fingerprint != chime::fingerprint() ||
+      header->sample_rate != SEGMENT_COUNT * SAMPLE_COUNT ||
+      header->sample_size != sizeof(sample_t) ||
+      header->count != CHIME_BANK_SIZE ||
+      size < DATA_OFFSET + std::size_t(header->count) * header->length *
+                               sizeof(sample_t))
+  {
+    return {};
+  }
+  auto samples = reinterpret_cast<const sample_t *>(
+      static_cast<const char *>(data) + DATA_OFFSET);
+  std::vector<chime> chimes;
+  for (std::uint32_t i = 0; i < header->count; ++i)
+  {
+    chimes.emplace_back(
+        std::shared_ptr<const sample_t>{mapping, samples + i * header->length},
+        header->length, header->scale[i]);
+  }
+  return chimes;
+}
+
+bool chime_bank::publish(int fd, const std::vector<chime> &chimes)
+{
+  std::size_t length = chimes.front().size();
+  auto size = DATA_OFFSET + chimes.size() * length * sizeof(sample_t);
+  if (ftruncate(fd, size) != 0)
+  {
+    return false;
+  }
+  auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+  auto header = static_cast<HEADER *>(data);
+  std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+  header->version = CHIME_BANK_VERSION;
+  header->fingerprint = chime::fingerprint();
+  header->sample_rate = SEGMENT_COUNT * SAMPLE_COUNT;
+  header->sample_size = sizeof(sample_t);
+  header->count = chimes.size();
+  header->length = length;
+  auto samples =
+      reinterpret_cast<sample_t *>(static_cast<char *>(data) + DATA_OFFSET);
+  for (std::size_t i = 0; i < chimes.size(); ++i)
+  {
+    header->scale[i] = chimes[i].scale();
+    std::memcpy(samples + i * length, chimes[i].data(),
+                length * sizeof(sample_t));
+  }
+  header->ready.store(1, std::memory_order_release);
+  munmap(data, size);
+  return true;
+}
+
+void chime_bank::remove_others(const char *name)
+{
+  // Banks of other versions or builds are never opened again by this one;
+  // clocks still using them keep their mappings. Only Linux lists them.
+  std::error_code error;
+  for (std::filesystem::directory_iterator entry{"/dev/shm", error};
+       !error && entry != std::filesystem::directory_iterator{};
+       entry.increment(error))
+  {
+    auto other = entry->path().filename().string();
+    if (other.compare(0, sizeof(PREFIX) - 1, PREFIX) == 0 &&
+        other != name + 1)
+    {
+      shm_unlink(("/" + other).c_str());
+    }
+  }
+}
+#else
+std::vector<chime> chime_bank::share() { return {}; }
+
+std::vector<chime> chime_bank::attach(int, bool &) { return {}; }
+
+bool chime_bank::publish(int, const std::vector<chime> &) { return false; }
+
+void chime_bank::remove_others(const char *) {}
+#endif
@@ -0,0 +1,28 @@
+#ifndef SRC_CHIME_BANK_H
+#define SRC_CHIME_BANK_H
+
+#include <vector>
+
+#include "chime.h"
+
+#define CHIME_BANK_SIZE 13
+#define CHIME_BANK_VERSION 1
+
+// The chimes of every pitch. The first clock on a host synthesizes them into
+// a named shared-memory object; later ones map it read-only instead of
+// synthesizing their own, and fall back to that if it does not match.
+// Creating a bank removes those of other versions and builds.
+class chime_bank
+{
+public:
+  static std::vector<chime> load();
+
+private:
+  static std::vector<chime> synthesize();
+  static std::vector<chime> share();
+  static std::vector<chime> attach(int fd, bool &stale);
+  static bool publish(int fd, const std::vector<chime> &chimes);
+  static void remove_others(const char *name);
+};
+
+#endif // SRC_CHIME_BANK_H
@@ -0,0 +1,190 @@
+#include "clock_face.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+  const float TURN = 8.0f * std::atan(1.0f);
+
+  std::vector<SDL_FPoint> turn(const std::vector<SDL_FPoint> &polygon,
+                               float angle, const SDL_FPoint &center)
+  {
+    auto cos = std::cos(angle);
+    auto sin = std::sin(angle);
+    std::vector<SDL_FPoint> turned;
+    for (const auto &point : polygon)
+    {
+      turned.push_back({center.x + point.x * cos - point.y * sin,
+                        center.y + point.x * sin + point.y * cos});
+    }
+    return turned;
+  }
+}
+
+clock_face::clock_face() : size_{0}, ticks_{}, numerals_{}, hands_{} {}
+
+clock_face::~clock_face() {}
+
+void clock_face::build(int size, TTF_Font *font)
+{
+  size_ = size;
+  float radius = size / 2.0f;
+  SDL_FPoint center{radius, radius};
+  ticks_ = {};
+  for (int i = 0; i < 60; ++i)
+  {
+    bool hour = i % 5 == 0;
+    float length = radius * (hour ? 0.1f : 0.04f);
+    float width = std::max(radius * (hour ? 0.025f : 0.008f), 1.5f);
+    float outer = radius * 0.95f;
+    add(ticks_, turn({{-width / 2, -outer},
+                      {width / 2, -outer},
+                      {width / 2, length - outer},
+                      {-width / 2, length - outer}},
+                     TURN * i / 60, center));
+  }
+  numerals_.clear();
+  for (int hour = 1; hour <= 12; ++hour)
+  {
+    auto surface = TTF_RenderText_Solid(font, std::to_string(hour).c_str(),
+                                        {255, 255, 255, 255});
+    if (!surface)
+    {
+      throw std::runtime_error("TTF_RenderText_Solid");
+    }
+    float distance = radius * 0.8f - surface->h * 0.55f;
+    float angle = TURN * hour / 12;
+    numerals_.push_back(
+        {{surface, SDL_FreeSurface},
+         {int(std::lround(radius + distance * std::sin(angle) - surface->w / 2.0f)),
+          int(std::lround(radius - distance * std::cos(angle) - surface->h / 2.0f)),
+          surface->w, surface->h}});
+  }
+  hands_ = {};
+  add(hands_[0], hand(radius * 0.12f, radius * 0.5f, radius * 0.07f,
+                      radius * 0.04f));
+  add(hands_[1], hand(radius * 0.12f, radius * 0.78f, radius * 0.05f,
+                      radius * 0.025f));
+  float second = std::max(radius * 0.015f, 2.0f);
+  add(hands_[2], hand(radius * 0.2f, radius * 0.9f, second, second));
+  std::vector<SDL_FPoint> hub;
+  for (int i = 0; i < 16; ++i)
+  {
+    hub.push_back({radius * 0.04f * std::sin(TURN * i / 16),
+                   -radius * 0.04f * std::cos(TURN * i / 16)});
+  }
+  add(hands_[3], hub);
+}
+
+int clock_face::size() const { return size_; }
+
+const clock_face::MESH &clock_face::ticks() const { return ticks_; }
+
+const std::vector<clock_face::NUMERAL> &clock_face::numerals() const
+{
+  return numerals_;
+}
+
+void clock_face::hands(float seconds, bool second_hand,
+                       const SDL_FPoint &center, const SDL_Color &color,
+                       std::vector<SDL_Vertex> &vertices,
+                       std::vector<int> &indices) const
+{
+  // Turns of the hour, minute and second hand; the hub does not turn.
+  const std::array<float, 4> turns = {seconds / (12 * 60 * 60),
+                                      seconds / (60 * 60), seconds / 60, 0.0f};
+  for (std::size_t i = 0; i < hands_.size(); ++i)
+  {
+    if (i == 2 && !second_hand)
+    {
+      continue;
+    }
+    auto angle = TURN * (turns[i] - std::floor(turns[i]));
+    auto cos = std::cos(angle);
+    auto sin = std::sin(angle);
+    int base = vertices.size();
+    for (const auto &vertex : hands_[i].vertices)
+    {
+      const auto &point = vertex.position;
+      vertices.push_back(
+          {{center.x + point.x * cos - point.y * sin,
+            center.y + point.x * sin + point.y * cos},
+           {color.r, color.g, color.b, Uint8(color.a * vertex.color.a / 255)},
+           {0.0f, 0.0f}});
+    }
+    for (const auto index : hands_[i].indices)
+    {
+      indices.push_back(base + index);
+    }
+  }
+}
+
+void clock_face::add(MESH &mesh, const std::vector<SDL_FPoint> &polygon)
+{
+  // A convex polygon as a fan of opaque triangles, surrounded by a ring of
+  // quads that fade to transparent FACE_FEATHER pixels further out, which
+  // anti-aliases the edges without multisampling.
+  auto count = polygon.size();
+  SDL_FPoint middle{0.0f, 0.0f};
+  for (const auto &point : polygon)
+  {
+    middle.x += point.x / count;
+    middle.y += point.y / count;
+  }
+  std::vector<SDL_FPoint> normals;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const auto &a = polygon[i];
+    const auto &b = polygon[(i + 1) % count];
+    SDL_FPoint normal{b.y - a.y, a.x - b.x};
+    auto length = std::hypot(normal.x, normal.y);
+    normal = {normal.x / length, normal.y / length};
+    if (normal.x * (a.x - middle.x) + normal.y * (a.y - middle.y) < 0)
+    {
+      normal = {-normal.x, -normal.y};
+    }
+    normals.push_back(normal);
+  }
+  int base = mesh.vertices.size();
+  for (const auto &point : polygon)
+  {
+    mesh.vertices.push_back({point, {255, 255, 255, 255}, {0.0f, 0.0f}});
+  }
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const auto &before = normals[(i + count - 1) % count];
+    const auto &after = normals[i];
+    SDL_FPoint normal{before.x + after.x, before.y + after.y};
+    auto scale = FACE_FEATHER / (normal.x * after.x + normal.y * after.y);
+    mesh.vertices.push_back({{polygon[i].x + normal.x * scale,
+                              polygon[i].y + normal.y * scale},
+                             {255, 255, 255, 0},
+                             {0.0f, 0.0f}});
+  }
+  for (std::size_t i = 1; i + 1 < count; ++i)
+  {
+    for (const auto index : {0, int(i), int(i + 1)})
+    {
+      mesh.indices.push_back(base + index);
+    }
+  }
+  for (int i = 0; i < int(count); ++i)
+  {
+    int j = (i + 1) % count;
+    int n = count;
+    for (const auto index : {i, j, n + j, i, n + j, n + i})
+    {
+      mesh.indices.push_back(base + index);
+    }
+  }
+}
+
+std::vector<SDL_FPoint> clock_face::hand(float tail, float length, float base,
+                                         float tip)
+{
+  return {{-base / 2, tail}, {base / 2, tail}, {tip / 2, -length},
+          {-tip / 2, -length}};
+}
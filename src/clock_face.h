@@ -0,0 +1,55 @@
+#ifndef SRC_CLOCK_FACE_H
+#define SRC_CLOCK_FACE_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#define FACE_FEATHER 1.0f
+
+// The geometry of an analog dial of a given size, in white. The dial itself
+// (ticks and numerals) is drawn once into a texture; the hands are meshes
+// around the centre, pointing at twelve, that are turned into place for
+// every frame. The edges of all meshes fade out over FACE_FEATHER pixels.
+class clock_face
+{
+public:
+  struct MESH
+  {
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+  };
+
+  struct NUMERAL
+  {
+    std::shared_ptr<SDL_Surface> surface;
+    SDL_Rect rect;
+  };
+
+private:
+  int size_;
+  MESH ticks_;
+  std::vector<NUMERAL> numerals_;
+  std::array<MESH, 4> hands_;
+
+public:
+  clock_face();
+  ~clock_face();
+  void build(int size, TTF_Font *font);
+  int size() const;
+  const MESH &ticks() const;
+  const std::vector<NUMERAL> &numerals() const;
+  void hands(float seconds, bool second_hand, const SDL_FPoint &center,
+             const SDL_Color &color, std::vector<SDL_Vertex> &vertices,
+             std::vector<int> &indices) const;
+
+private:
+  static void add(MESH &mesh, const std::vector<SDL_FPoint> &polygon);
+  static std::vector<SDL_FPoint> hand(float tail, float length, float base,
+                                      float tip);
+};
+
+#endif // SRC_CLOCK_FACE_H
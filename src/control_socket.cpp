@@ -0,0 +1,207 @@
+#include "control_socket.h"
+
+#include <cerrno>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+control_socket::CLIENT::~CLIENT()
+{
+#ifndef _WIN32
+  close(fd);
+#endif
+}
+
+#ifndef _WIN32
+control_socket::control_socket(const std::string &path, Uint32 event_type)
+    : path_{path},
+      event_type_{event_type},
+      listener_{-1},
+      wake_{-1, -1},
+      connections_{},
+      thread_{}
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path_.size() >= sizeof(address.sun_path))
+  {
+    throw std::runtime_error("control socket path too long");
+  }
+  path_.copy(address.sun_path, path_.size());
+  listener_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener_ < 0)
+  {
+    throw std::runtime_error("socket");
+  }
+  // Only a stale socket is replaced, never a file the path names by mistake.
+  struct stat status;
+  if (lstat(path_.c_str(), &status) == 0)
+  {
+    if (!S_ISSOCK(status.st_mode))
+    {
+      close(listener_);
+      throw std::runtime_error("control socket path is not a socket");
+    }
+    unlink(path_.c_str());
+  }
+  else if (errno != ENOENT)
+  {
+    close(listener_);
+    throw std::runtime_error("lstat(control socket)");
+  }
+  // The socket is created accessible to the user only, with no window in
+  // which others could connect.
+  auto mask = umask(077);
+  auto bound = bind(listener_, reinterpret_cast<const sockaddr *>(&address),
+                    sizeof(address));
+  umask(mask);
+  if (bound != 0 || listen(listener_, 4) != 0)
+  {
+    close(listener_);
+    throw std::runtime_error("bind(control socket)");
+  }
+  if (pipe(wake_) != 0)
+  {
+    close(listener_);
+    unlink(path_.c_str());
+    throw std::runtime_error("pipe");
+  }
+  thread_ = std::thread(&control_socket::serve, this);
+}
+
+control_socket::~control_socket()
+{
+  char stop = 0;
+  if (write(wake_[1], &stop, 1) == 1)
+  {
+    thread_.join();
+  }
+  else
+  {
+    thread_.detach();
+  }
+  connections_.clear();
+  close(wake_[0]);
+  close(wake_[1]);
+  close(listener_);
+  unlink(path_.c_str());
+}
+
+void control_socket::reply(const COMMAND &command, const std::string &text)
+{
+  auto line = text + "\n";
+  std::lock_guard<std::mutex> lock{command.client->mutex};
+  std::size_t sent = 0;
+  while (sent < line.size())
+  {
+    auto result = send(command.client->fd, line.data() + sent,
+                       line.size() - sent, MSG_NOSIGNAL);
+    if (result <= 0)
+    {
+      break;
+    }
+    sent += result;
+  }
+}
+
+void control_socket::serve()
+{
+  std::vector<pollfd> polled;
+  for (;;)
+  {
+    polled.clear();
+    polled.push_back({wake_[0], POLLIN, 0});
+    polled.push_back({listener_, POLLIN, 0});
+    for (const auto &connection : connections_)
+    {
+      polled.push_back({connection.client->fd, POLLIN, 0});
+    }
+    if (poll(polled.data(), polled.size(), -1) < 0)
+    {
+      continue;
+    }
+    if (polled[0].revents)
+    {
+      break;
+    }
+    // Connections are read before new ones are accepted so that the
+    // indices into polled stay in step with connections_.
+    for (std::size_t i = connections_.size(); i-- > 0;)
+    {
+      if (polled[i + 2].revents && !receive(connections_[i]))
+      {
+        connections_.erase(connections_.begin() + i);
+      }
+    }
+    if (polled[1].revents & POLLIN)
+    {
+      auto fd = accept(listener_, nullptr, nullptr);
+      if (fd >= 0)
+      {
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        connections_.push_back({std::shared_ptr<CLIENT>(new CLIENT{fd, {}}), {}});
+      }
+    }
+  }
+}
+
+bool control_socket::receive(CONNECTION &connection)
+{
+  char buffer[512];
+  auto length = recv(connection.client->fd, buffer, sizeof(buffer), 0);
+  if (length <= 0)
+  {
+    return false;
+  }
+  auto received = std::chrono::steady_clock::now();
+  connection.pending.append(buffer, length);
+  std::size_t end;
+  while ((end = connection.pending.find('\n')) != std::string::npos)
+  {
+    auto line = connection.pending.substr(0, end);
+    connection.pending.erase(0, end + 1);
+    if (!line.empty() && line.back() == '\r')
+    {
+      line.pop_back();
+    }
+    auto command = new COMMAND{line, received, connection.client};
+    SDL_Event event{};
+    event.type = event_type_;
+    event.user.data1 = command;
+    if (SDL_PushEvent(&event) != 1)
+    {
+      reply(*command, "ERR busy");
+      delete command;
+    }
+  }
+  return connection.pending.size() < 4096;
+}
+#else
+control_socket::control_socket(const std::string &path, Uint32 event_type)
+    : path_{path},
+      event_type_{event_type},
+      listener_{-1},
+      wake_{-1, -1},
+      connections_{},
+      thread_{}
+{
+  throw std::runtime_error("control socket is not supported");
+}
+
+control_socket::~control_socket() {}
+
+void control_socket::reply(const COMMAND &, const std::string &) {}
+#endif
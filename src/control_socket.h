@@ -0,0 +1,58 @@
+#ifndef SRC_CONTROL_SOCKET_H
+#define SRC_CONTROL_SOCKET_H
+
+#include <SDL.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Listens on a Unix-domain socket and turns every received line into an SDL
+// event of the given type, whose user.data1 owns a COMMAND.
+class control_socket
+{
+public:
+  // Both the listener thread (ERR busy) and the control thread reply on a
+  // connection, one line at a time under its mutex.
+  struct CLIENT
+  {
+    int fd;
+    std::mutex mutex;
+    ~CLIENT();
+  };
+
+  struct COMMAND
+  {
+    std::string line;
+    std::chrono::steady_clock::time_point received;
+    std::shared_ptr<CLIENT> client;
+  };
+
+private:
+  struct CONNECTION
+  {
+    std::shared_ptr<CLIENT> client;
+    std::string pending;
+  };
+
+  const std::string path_;
+  const Uint32 event_type_;
+  int listener_;
+  int wake_[2];
+  std::vector<CONNECTION> connections_;
+  std::thread thread_;
+
+public:
+  control_socket(const std::string &path, Uint32 event_type);
+  ~control_socket();
+  static void reply(const COMMAND &command, const std::string &text);
+
+private:
+  void serve();
+  bool receive(CONNECTION &connection);
+};
+
+#endif // SRC_CONTROL_SOCKET_H
@@ -0,0 +1,117 @@
+#include "event_log.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+  const char MAGIC[8] = {'C', 'L', 'K', 'E', 'V', 'E', 'N', 'T'};
+  const std::uint32_t VERSION = 1;
+
+  template <typename T>
+  void put(std::fstream &file, T value)
+  {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  bool get(std::fstream &file, T &value)
+  {
+    return bool(file.read(reinterpret_cast<char *>(&value), sizeof(value)));
+  }
+}
+
+event_log::event_log()
+    : file_{},
+      start_{},
+      origin_{}
+{
+}
+
+event_log::~event_log() {}
+
+void event_log::create(const std::string &path,
+                       std::chrono::system_clock::time_point start,
+                       std::chrono::steady_clock::time_point origin)
+{
+  file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file_)
+  {
+    throw std::runtime_error("event_log::create");
+  }
+  start_ = start;
+  origin_ = origin;
+  file_.write(MAGIC, sizeof(MAGIC));
+  put(file_, VERSION);
+  put(file_, std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              start.time_since_epoch())
+                              .count()));
+}
+
+void event_log::open(const std::string &path)
+{
+  file_.open(path, std::ios::in | std::ios::binary);
+  char magic[sizeof(MAGIC)];
+  std::uint32_t version;
+  std::int64_t start;
+  if (!file_ || !file_.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !get(file_, version) || version != VERSION || !get(file_, start))
+  {
+    throw std::runtime_error("event_log::open");
+  }
+  start_ = std::chrono::system_clock::time_point{
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds{start})};
+}
+
+bool event_log::is_open() const { return file_.is_open(); }
+
+std::chrono::system_clock::time_point event_log::start() const
+{
+  return start_;
+}
+
+void event_log::tick(std::chrono::system_clock::time_point wall,
+                     std::chrono::steady_clock::time_point steady)
+{
+  write({std::chrono::duration_cast<std::chrono::nanoseconds>(steady - origin_)
+             .count(),
+         std::chrono::duration_cast<std::chrono::nanoseconds>(
+             wall.time_since_epoch())
+             .count(),
+         0, 0, 0, 0, 0});
+}
+
+void event_log::event(std::chrono::system_clock::time_point wall,
+                      std::chrono::steady_clock::time_point steady,
+                      std::uint32_t type, std::int32_t code,
+                      std::uint32_t screen, std::int32_t data1,
+                      std::int32_t data2)
+{
+  write({std::chrono::duration_cast<std::chrono::nanoseconds>(steady - origin_)
+             .count(),
+         std::chrono::duration_cast<std::chrono::nanoseconds>(
+             wall.time_since_epoch())
+             .count(),
+         type, code, screen, data1, data2});
+}
+
+bool event_log::read(RECORD &record)
+{
+  return get(file_, record.steady) && get(file_, record.wall) &&
+         get(file_, record.type) && get(file_, record.code) &&
+         get(file_, record.screen) && get(file_, record.data1) &&
+         get(file_, record.data2);
+}
+
+void event_log::write(const RECORD &record)
+{
+  put(file_, record.steady);
+  put(file_, record.wall);
+  put(file_, record.type);
+  put(file_, record.code);
+  put(file_, record.screen);
+  put(file_, record.data1);
+  put(file_, record.data2);
+}
@@ -0,0 +1,52 @@
+#ifndef SRC_EVENT_LOG_H
+#define SRC_EVENT_LOG_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// A recording of what the control thread handled: each tick and each event
+// with the clock readings at the time and the fields handle_event looks at,
+// as fixed-size binary records.
+class event_log
+{
+public:
+  struct RECORD
+  {
+    std::int64_t steady;
+    std::int64_t wall;
+    std::uint32_t type;
+    std::int32_t code;
+    std::uint32_t screen;
+    std::int32_t data1;
+    std::int32_t data2;
+  };
+
+private:
+  std::fstream file_;
+  std::chrono::system_clock::time_point start_;
+  std::chrono::steady_clock::time_point origin_;
+
+public:
+  event_log();
+  ~event_log();
+  void create(const std::string &path,
+              std::chrono::system_clock::time_point start,
+              std::chrono::steady_clock::time_point origin);
+  void open(const std::string &path);
+  bool is_open() const;
+  std::chrono::system_clock::time_point start() const;
+  void tick(std::chrono::system_clock::time_point wall,
+            std::chrono::steady_clock::time_point steady);
+  void event(std::chrono::system_clock::time_point wall,
+             std::chrono::steady_clock::time_point steady, std::uint32_t type,
+             std::int32_t code, std::uint32_t screen, std::int32_t data1,
+             std::int32_t data2);
+  bool read(RECORD &record);
+
+private:
+  void write(const RECORD &record);
+};
+
+#endif // SRC_EVENT_LOG_H
@@ -0,0 +1,238 @@
+#include "font_cache.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "resources.h"
+
+font_cache::font_cache(counter *opens)
+    : face_{embedded()},
+      fonts_{},
+      opens_{opens}
+{
+}
+
+font_cache::~font_cache() { clear(); }
+
+void font_cache::clear()
+{
+  for (auto &font : fonts_)
+  {
+    TTF_CloseFont(font.font);
+  }
+  fonts_.clear();
+}
+
+bool font_cache::select(const std::string &path)
+{
+  if (path.empty())
+  {
+    if (face_->path.empty())
+    {
+      return false;
+    }
+    face_ = embedded();
+    return true;
+  }
+  // A file rewritten in place may keep its time but not its size.
+  std::error_code error;
+  auto time = std::filesystem::last_write_time(path, error);
+  auto size = error ? 0 : std::filesystem::file_size(path, error);
+  if (error)
+  {
+    if (face_->path.empty())
+    {
+      return false;
+    }
+    face_ = embedded();
+    return true;
+  }
+  if (path == face_->path && time == face_->time && size == face_->size)
+  {
+    return false;
+  }
+  for (const auto &font : fonts_)
+  {
+    if (font.face->path == path && font.face->time == time &&
+        font.face->size == size)
+    {
+      face_ = font.face;
+      return true;
+    }
+  }
+  auto face = map(path);
+  if (!face)
+  {
+    if (face_->path.empty())
+    {
+      return false;
+    }
+    face = embedded();
+  }
+  face_ = face;
+  return true;
+}
+
+const std::string &font_cache::path() const { return face_->path; }
+
+TTF_Font *font_cache::open(int size)
+{
+  for (auto font = fonts_.begin(); font != fonts_.end(); ++font)
+  {
+    if (font->face == face_ && font->size == size)
+    {
+      ++font->users;
+      fonts_.splice(fonts_.begin(), fonts_, font);
+      return font->font;
+    }
+  }
+  auto font = load(size);
+  fonts_.push_front({face_, size, font, 1});
+  trim();
+  return font;
+}
+
+std::shared_ptr<TTF_Font> font_cache::open_private(int size)
+{
+  // A font of its own, for another thread to render with; the face stays
+  // mapped until the font is closed.
+  return {load(size), [face = face_](TTF_Font *font) { TTF_CloseFont(font); }};
+}
+
+void font_cache::close(TTF_Font *font)
+{
+  for (auto &cached : fonts_)
+  {
+    if (cached.font == font)
+    {
+      --cached.users;
+      break;
+    }
+  }
+  trim();
+}
+
+std::shared_ptr<const font_cache::FACE> font_cache::embedded()
+{
+  static const std::shared_ptr<const FACE> face = std::make_shared<FACE>(
+      FACE{"", {}, Font_ttf().data, std::size_t(Font_ttf().size), nullptr});
+  return face;
+}
+
+std::shared_ptr<const font_cache::FACE>
+font_cache::map(const std::string &path)
+{
+  std::error_code error;
+  auto time = std::filesystem::last_write_time(path, error);
+  auto size = std::filesystem::file_size(path, error);
+  if (error || size == 0 || size > std::size_t(INT32_MAX))
+  {
+    return nullptr;
+  }
+#ifdef _WIN32
+  auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return nullptr;
+  }
+  auto mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+  {
+    return nullptr;
+  }
+  auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+  if (!data)
+  {
+    CloseHandle(mapping);
+    return nullptr;
+  }
+#else
+  // The size is taken from the descriptor that is mapped, and the mapping
+  // is private; still, a file truncated in place while mapped makes reading
+  // the lost pages fault, so fonts should be replaced by renaming.
+  auto file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    return nullptr;
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 || status.st_size <= 0 ||
+      std::uintmax_t(status.st_size) > std::uintmax_t(INT32_MAX))
+  {
+    ::close(file);
+    return nullptr;
+  }
+  size = status.st_size;
+  auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+  if (data == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  void *mapping = nullptr;
+#endif
+  return std::shared_ptr<const FACE>(
+      new FACE{path, time, data, std::size_t(size), mapping}, unmap);
+}
+
+void font_cache::unmap(const FACE *face)
+{
+#ifdef _WIN32
+  UnmapViewOfFile(face->data);
+  CloseHandle(face->mapping);
+#else
+  munmap(const_cast<void *>(face->data), face->size);
+#endif
+  delete face;
+}
+
+TTF_Font *font_cache::load(int size)
+{
+  auto source = SDL_RWFromConstMem(face_->data, int(face_->size));
+  if (!source)
+  {
+    throw std::runtime_error("SDL_RWFromConstMem");
+  }
+  auto font = TTF_OpenFontRW(source, true, size);
+  if (!font)
+  {
+    throw std::runtime_error("TTF_OpenFont");
+  }
+  if (opens_)
+  {
+    opens_->add();
+  }
+  return font;
+}
+
+void font_cache::trim()
+{
+  std::size_t idle = 0;
+  for (auto font = fonts_.begin(); font != fonts_.end();)
+  {
+    if (font->users <= 0 &&
+        ((font->face != face_ && font->face->path == face_->path) ||
+         ++idle > IDLE_FONTS))
+    {
+      TTF_CloseFont(font->font);
+      font = fonts_.erase(font);
+    }
+    else
+    {
+      ++font;
+    }
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef SRC_FONT_CACHE_H
+#define SRC_FONT_CACHE_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "metrics.h"
+
+#define IDLE_FONTS 6
+
+class font_cache
+{
+private:
+  struct FACE
+  {
+    std::string path;
+    std::filesystem::file_time_type time;
+    const void *data;
+    std::size_t size;
+    void *mapping;
+  };
+
+  struct FONT
+  {
+    std::shared_ptr<const FACE> face;
+    int size;
+    TTF_Font *font;
+    int users;
+  };
+
+  std::shared_ptr<const FACE> face_;
+  std::list<FONT> fonts_;
+  counter *opens_;
+
+public:
+  font_cache(counter *opens);
+  ~font_cache();
+  void clear();
+  bool select(const std::string &path);
+  const std::string &path() const;
+  TTF_Font *open(int size);
+  std::shared_ptr<TTF_Font> open_private(int size);
+  void close(TTF_Font *font);
+
+private:
+  static std::shared_ptr<const FACE> embedded();
+  static std::shared_ptr<const FACE> map(const std::string &path);
+  static void unmap(const FACE *face);
+  TTF_Font *load(int size);
+  void trim();
+};
+
+#endif // SRC_FONT_CACHE_H
@@ -0,0 +1,325 @@
+#include "glyph_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+glyph_atlas::glyph_atlas()
+    : surface_{},
+      size_{0, 0},
+      height_{0},
+      spread_{0},
+      glyphs_{},
+      advances_{}
+{
+}
+
+glyph_atlas::~glyph_atlas() {}
+
+void glyph_atlas::build(TTF_Font *font, const char *glyphs, bool solid)
+{
+  // Glyphs are packed in rows no wider than ATLAS_WIDTH, so the atlas of a
+  // big font still fits in a texture.
+  spread_ = 0;
+  glyphs_.fill({0, 0, 0, 0});
+  advances_.fill(0);
+  std::vector<SDL_Surface *> surfaces;
+  height_ = TTF_FontHeight(font);
+  size_ = {1, height_};
+  SDL_Point next = {1, 0};
+  for (auto c = glyphs; *c; ++c)
+  {
+    const char text[2] = {*c, '\0'};
+    auto surface =
+        solid ? TTF_RenderText_Solid(font, text, {255, 255, 255, 255})
+              : TTF_RenderText_Blended(font, text, {255, 255, 255, 255});
+    if (!surface)
+    {
+      throw std::runtime_error("TTF_RenderText");
+    }
+    if (next.x > 1 && next.x + surface->w > ATLAS_WIDTH)
+    {
+      next = {1, size_.y + 1};
+    }
+    glyphs_[*c & 0x7f] = {next.x, next.y, surface->w, surface->h};
+    advances_[*c & 0x7f] = surface->w;
+    next.x += surface->w + 1;
+    size_.x = std::max(size_.x, next.x);
+    size_.y = std::max(size_.y, next.y + surface->h);
+    height_ = std::max(height_, surface->h);
+    surfaces.push_back(surface);
+  }
+  auto atlas = SDL_CreateRGBSurfaceWithFormat(0, size_.x, size_.y, 32,
+                                              SDL_PIXELFORMAT_ARGB8888);
+  if (!atlas)
+  {
+    throw std::runtime_error("SDL_CreateRGBSurfaceWithFormat");
+  }
+  for (std::size_t i = 0; i < surfaces.size(); ++i)
+  {
+    SDL_Rect dest = glyphs_[glyphs[i] & 0x7f];
+    SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+    if (SDL_BlitSurface(surfaces[i], nullptr, atlas, &dest) != 0)
+    {
+      throw std::runtime_error("SDL_BlitSurface");
+    }
+    SDL_FreeSurface(surfaces[i]);
+  }
+  surface_.reset(atlas, SDL_FreeSurface);
+}
+
+void glyph_atlas::build_distance(TTF_Font *font)
+{
+  // A signed distance field of every glyph the font has, which is opened at
+  // DISTANCE_OVERSAMPLE times the size of the atlas: each pixel holds 0.5 on
+  // the outline, rising inside and falling outside by 0.5 over
+  // DISTANCE_SPREAD pixels, in all four channels. The exact distances of the
+  // large render are averaged over the pixels of the atlas, so the outline
+  // keeps its fractional position. Drawn scaled with linear filtering and
+  // cut at 0.5 it gives sharp glyphs at any size.
+  const int over = DISTANCE_OVERSAMPLE;
+  spread_ = DISTANCE_SPREAD;
+  glyphs_.fill({0, 0, 0, 0});
+  advances_.fill(0);
+  height_ = (TTF_FontHeight(font) + over - 1) / over;
+  // The space has no outline to draw, only its advance.
+  int advance;
+  if (TTF_GlyphMetrics(font, ' ', nullptr, nullptr, nullptr, nullptr,
+                       &advance) == 0)
+  {
+    advances_[' '] = std::lround(float(advance) / over);
+  }
+  std::vector<std::pair<char, std::vector<Uint8>>> fields;
+  SDL_Point size{1, height_ + 2 * spread_};
+  SDL_Point next{1, 0};
+  for (int c = 1; c < 127; ++c)
+  {
+    if (c == ' ' || !TTF_GlyphIsProvided(font, c))
+    {
+      continue;
+    }
+    const char text[2] = {char(c), '\0'};
+    auto rendered = TTF_RenderText_Blended(font, text, {255, 255, 255, 255});
+    if (!rendered)
+    {
+      throw std::runtime_error("TTF_RenderText_Blended");
+    }
+    auto coverage =
+        SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(rendered);
+    if (!coverage)
+    {
+      throw std::runtime_error("SDL_ConvertSurfaceFormat");
+    }
+    // Every glyph keeps DISTANCE_SPREAD pixels of margin on each side.
+    int w = (coverage->w + over - 1) / over + 2 * spread_;
+    int h = (coverage->h + over - 1) / over + 2 * spread_;
+    advances_[c] = std::lround(float(coverage->w) / over);
+    // Squared distances of the large render to the nearest pixel inside and
+    // to the nearest one outside the glyph, which is where it is at least
+    // half covered.
+    int large_w = w * over;
+    int large_h = h * over;
+    int margin = spread_ * over;
+    std::vector<float> to_inside(large_w * large_h, DISTANCE_FAR);
+    std::vector<float> to_outside(large_w * large_h, 0.0f);
+    for (int y = 0; y < coverage->h; ++y)
+    {
+      auto row = static_cast<const Uint32 *>(coverage->pixels) +
+                 y * coverage->pitch / 4;
+      for (int x = 0; x < coverage->w; ++x)
+      {
+        if (row[x] >> 24 >= 128)
+        {
+          auto i = (y + margin) * large_w + x + margin;
+          to_inside[i] = 0.0f;
+          to_outside[i] = DISTANCE_FAR;
+        }
+      }
+    }
+    SDL_FreeSurface(coverage);
+    transform(to_inside, large_w, large_h);
+    transform(to_outside, large_w, large_h);
+    std::vector<Uint8> field(w * h);
+    for (int y = 0; y < h; ++y)
+    {
+      for (int x = 0; x < w; ++x)
+      {
+        float distance = 0.0f;
+        for (int dy = 0; dy < over; ++dy)
+        {
+          for (int dx = 0; dx < over; ++dx)
+          {
+            auto i = (y * over + dy) * large_w + x * over + dx;
+            // The outline lies halfway between a pixel and its nearest
+            // opposite.
+            distance += to_inside[i] == 0.0f
+                            ? std::sqrt(to_outside[i]) - 0.5f
+                            : 0.5f - std::sqrt(to_inside[i]);
+          }
+        }
+        distance /= over * over * over;
+        field[y * w + x] = Uint8(std::clamp(
+            std::lround(255 * (0.5f + distance / (2 * spread_))), 0L, 255L));
+      }
+    }
+    if (next.x > 1 && next.x + w > ATLAS_WIDTH)
+    {
+      next = {1, size.y + 1};
+    }
+    glyphs_[c] = {next.x, next.y, w, h};
+    next.x += w + 1;
+    size.x = std::max(size.x, next.x);
+    size.y = std::max(size.y, next.y + h);
+    fields.emplace_back(char(c), std::move(field));
+  }
+  auto atlas = SDL_CreateRGBSurfaceWithFormat(0, size.x, size.y, 32,
+                                              SDL_PIXELFORMAT_ARGB8888);
+  if (!atlas)
+  {
+    throw std::runtime_error("SDL_CreateRGBSurfaceWithFormat");
+  }
+  auto pixels = static_cast<Uint32 *>(atlas->pixels);
+  for (const auto &[c, field] : fields)
+  {
+    const auto &glyph = glyphs_[c];
+    for (int y = 0; y < glyph.h; ++y)
+    {
+      for (int x = 0; x < glyph.w; ++x)
+      {
+        pixels[(glyph.y + y) * atlas->pitch / 4 + glyph.x + x] =
+            field[y * glyph.w + x] * 0x01010101u;
+      }
+    }
+  }
+  size_ = size;
+  surface_.reset(atlas, SDL_FreeSurface);
+}
+
+void glyph_atlas::transform(std::vector<float> &grid, int w, int h)
+{
+  // The exact squared Euclidean distance transform of Felzenszwalb and
+  // Huttenlocher: every cell ends up with the squared distance to the
+  // nearest cell that was 0, one dimension at a time.
+  std::vector<float> line(std::max(w, h));
+  std::vector<float> result(line.size());
+  std::vector<int> parabolas(line.size());
+  std::vector<float> bounds(line.size() + 1);
+  auto pass = [&](int n)
+  {
+    int k = 0;
+    parabolas[0] = 0;
+    bounds[0] = -DISTANCE_FAR;
+    bounds[1] = DISTANCE_FAR;
+    for (int q = 1; q < n; ++q)
+    {
+      auto intersection = [&](int p)
+      {
+        return ((line[q] + float(q) * q) - (line[p] + float(p) * p)) /
+               (2.0f * (q - p));
+      };
+      auto s = intersection(parabolas[k]);
+      while (s <= bounds[k])
+      {
+        s = intersection(parabolas[--k]);
+      }
+      ++k;
+      parabolas[k] = q;
+      bounds[k] = s;
+      bounds[k + 1] = DISTANCE_FAR;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q)
+    {
+      while (bounds[k + 1] < q)
+      {
+        ++k;
+      }
+      int p = parabolas[k];
+      result[q] = float(q - p) * (q - p) + line[p];
+    }
+  };
+  for (int x = 0; x < w; ++x)
+  {
+    for (int y = 0; y < h; ++y)
+    {
+      line[y] = grid[y * w + x];
+    }
+    pass(h);
+    for (int y = 0; y < h; ++y)
+    {
+      grid[y * w + x] = result[y];
+    }
+  }
+  for (int y = 0; y < h; ++y)
+  {
+    std::copy(grid.begin() + y * w, grid.begin() + (y + 1) * w, line.begin());
+    pass(w);
+    std::copy(result.begin(), result.begin() + w, grid.begin() + y * w);
+  }
+}
+
+int glyph_atlas::spread() const { return spread_; }
+
+const std::shared_ptr<SDL_Surface> &glyph_atlas::surface() const
+{
+  return surface_;
+}
+
+SDL_Point glyph_atlas::measure(const char *text) const
+{
+  SDL_Point size{0, height_};
+  for (auto c = text; *c; ++c)
+  {
+    size.x += advances_[*c & 0x7f];
+  }
+  return size;
+}
+
+int glyph_atlas::width(char c) const { return advances_[c & 0x7f]; }
+
+void glyph_atlas::glyph(char c, const SDL_FRect &dest, float top,
+                        float bottom, const SDL_Color &color,
+                        std::vector<SDL_Vertex> &vertices,
+                        std::vector<int> &indices) const
+{
+  // Draws the rows from top to bottom, as fractions of the glyph's height,
+  // stretched over dest.
+  const auto &glyph = glyphs_[c & 0x7f];
+  if (glyph.w == 0 || dest.h <= 0.0f || bottom <= top)
+  {
+    return;
+  }
+  float u0 = float(glyph.x) / size_.x;
+  float u1 = float(glyph.x + glyph.w) / size_.x;
+  float v0 = (glyph.y + top * glyph.h) / size_.y;
+  float v1 = (glyph.y + bottom * glyph.h) / size_.y;
+  int base = vertices.size();
+  vertices.push_back({{dest.x, dest.y}, color, {u0, v0}});
+  vertices.push_back({{dest.x + dest.w, dest.y}, color, {u1, v0}});
+  vertices.push_back({{dest.x + dest.w, dest.y + dest.h}, color, {u1, v1}});
+  vertices.push_back({{dest.x, dest.y + dest.h}, color, {u0, v1}});
+  for (const auto index : {0, 1, 2, 0, 2, 3})
+  {
+    indices.push_back(base + index);
+  }
+}
+
+void glyph_atlas::layout(const char *text, const int x, const int y,
+                         const SDL_Color &color,
+                         std::vector<SDL_Vertex> &vertices,
+                         std::vector<int> &indices, float scale) const
+{
+  float left = x;
+  float margin = spread_ * scale;
+  for (auto c = text; *c; ++c)
+  {
+    const auto &glyph = glyphs_[*c & 0x7f];
+    glyph_atlas::glyph(*c,
+                       {left - margin, y - margin, glyph.w * scale,
+                        glyph.h * scale},
+                       0.0f, 1.0f, color, vertices, indices);
+    left += width(*c) * scale;
+  }
+}
@@ -0,0 +1,47 @@
+#ifndef SRC_GLYPH_ATLAS_H
+#define SRC_GLYPH_ATLAS_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#define ATLAS_WIDTH 2048
+#define DISTANCE_SIZE 96
+#define DISTANCE_SPREAD 6
+#define DISTANCE_OVERSAMPLE 4
+#define DISTANCE_FAR 1e20f
+
+class glyph_atlas
+{
+private:
+  std::shared_ptr<SDL_Surface> surface_;
+  SDL_Point size_;
+  int height_;
+  int spread_;
+  std::array<SDL_Rect, 128> glyphs_;
+  std::array<int, 128> advances_;
+
+public:
+  glyph_atlas();
+  ~glyph_atlas();
+  void build(TTF_Font *font, const char *glyphs, bool solid = false);
+  void build_distance(TTF_Font *font);
+  int spread() const;
+  const std::shared_ptr<SDL_Surface> &surface() const;
+  SDL_Point measure(const char *text) const;
+  int width(char c) const;
+  void glyph(char c, const SDL_FRect &dest, float top, float bottom,
+             const SDL_Color &color, std::vector<SDL_Vertex> &vertices,
+             std::vector<int> &indices) const;
+  void layout(const char *text, const int x, const int y,
+              const SDL_Color &color, std::vector<SDL_Vertex> &vertices,
+              std::vector<int> &indices, float scale = 1.0f) const;
+
+private:
+  static void transform(std::vector<float> &grid, int w, int h);
+};
+
+#endif // SRC_GLYPH_ATLAS_H
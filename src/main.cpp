@@ -1,39 +1,102 @@
 #include <cstring>
+#include <ctime>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include "wall_clock.h"
 
+namespace
+{
+  bool parse_time(const char *text, std::chrono::system_clock::time_point &time)
+  {
+    std::tm tm{};
+    std::istringstream is{text};
+    is >> std::get_time(&tm, "%Y-%m-%dT%H:%M");
+    if (is.fail())
+    {
+      return false;
+    }
+    tm.tm_isdst = -1;
+    auto t = std::mktime(&tm);
+    if (t == -1)
+    {
+      return false;
+    }
+    time = std::chrono::system_clock::from_time_t(t);
+    return true;
+  }
+}
+
 int main(int argc, char *argv[])
 {
-  if (argc > 1)
+  wall_clock::OPTIONS options{};
+  for (int i = 1; i < argc; ++i)
   {
-    if (argc == 2 && std::strcmp("--version", argv[1]) == 0)
+    if (argc == 2 && std::strcmp("--version", argv[i]) == 0)
     {
       std::cout << "Clock: " << PROJECT_VERSION << std::endl;
       return 0;
     }
-    else
+    else if (std::strcmp("--startup-trace", argv[i]) == 0)
     {
-      std::cerr << "Unknown option" << std::endl;
-      return -1;
+      options.startup_trace = true;
     }
-  }
-  else
-  {
-    try
+    else if (std::strcmp("--all-displays", argv[i]) == 0)
+    {
+      options.all_displays = true;
+    }
+    else if (std::strcmp("--control-socket", argv[i]) == 0 && i + 1 < argc)
+    {
+      options.control_socket = argv[++i];
+    }
+    else if (std::strcmp("--metrics", argv[i]) == 0 && i + 1 < argc)
+    {
+      options.metrics = argv[++i];
+    }
+    else if (std::strcmp("--trace", argv[i]) == 0 && i + 1 < argc)
+    {
+      options.trace = argv[++i];
+    }
+    else if (std::strcmp("--simulate", argv[i]) == 0 && i + 2 < argc &&
+             parse_time(argv[i + 1], options.simulate_from) &&
+             parse_time(argv[i + 2], options.simulate_to))
+    {
+      options.simulate = true;
+      i += 2;
+    }
+    else if (std::strcmp("--record", argv[i]) == 0 && i + 1 < argc)
+    {
+      options.record = argv[++i];
+    }
+    else if (std::strcmp("--replay", argv[i]) == 0 && i + 1 < argc)
     {
-      wall_clock w_c{
-          (std::filesystem::path{argv[0]}.parent_path() /
-           HELP_RELATIVE_PATH)
-              .string()};
-      w_c.run();
+      options.replay = argv[++i];
     }
-    catch (const char *error)
+    else if (std::strcmp("--fast", argv[i]) == 0)
     {
-      std::cout << "Exception: " << error << std::endl;
+      options.fast = true;
+    }
+    else
+    {
+      std::cerr << "Unknown option" << std::endl;
       return -1;
     }
-    return 0;
   }
+  try
+  {
+    wall_clock w_c{
+        (std::filesystem::path{argv[0]}.parent_path() /
+         HELP_RELATIVE_PATH)
+            .string(),
+        options};
+    w_c.run();
+  }
+  catch (const char *error)
+  {
+    std::cout << "Exception: " << error << std::endl;
+    return -1;
+  }
+  return 0;
 }
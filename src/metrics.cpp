@@ -0,0 +1,145 @@
+#include "metrics.h"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+counter::counter() : value_{0} {}
+
+void counter::add(std::uint64_t amount)
+{
+  value_.fetch_add(amount, std::memory_order_relaxed);
+}
+
+std::uint64_t counter::value() const
+{
+  return value_.load(std::memory_order_relaxed);
+}
+
+gauge::gauge() : value_{0} {}
+
+void gauge::set(std::int64_t value)
+{
+  value_.store(value, std::memory_order_relaxed);
+}
+
+std::int64_t gauge::value() const
+{
+  return value_.load(std::memory_order_relaxed);
+}
+
+histogram::histogram() : buckets_{}, sum_{0} {}
+
+void histogram::observe(std::chrono::steady_clock::duration duration)
+{
+  auto microseconds =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  std::size_t bucket = 0;
+  while (bucket < bounds_.size() && microseconds > bounds_[bucket])
+  {
+    ++bucket;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(microseconds > 0 ? microseconds : 0,
+                 std::memory_order_relaxed);
+}
+
+void histogram::write(std::ostream &os, const char *name) const
+{
+  std::uint64_t count = 0;
+  for (std::size_t bucket = 0; bucket < buckets_.size(); ++bucket)
+  {
+    count += buckets_[bucket].load(std::memory_order_relaxed);
+    os << name << "_bucket{le=\"";
+    if (bucket < bounds_.size())
+    {
+      os << bounds_[bucket] / 1e6;
+    }
+    else
+    {
+      os << "+Inf";
+    }
+    os << "\"} " << count << '\n';
+  }
+  os << name << "_sum " << sum_.load(std::memory_order_relaxed) / 1e6 << '\n'
+     << name << "_count " << count << '\n';
+}
+
+metrics::metrics() : stopping_{false} {}
+
+metrics::~metrics()
+{
+  if (thread_.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stopping_ = true;
+    }
+    signal_.notify_all();
+    thread_.join();
+  }
+}
+
+void metrics::start(const std::string &path, std::chrono::seconds interval)
+{
+  path_ = path;
+  thread_ = std::thread(
+      [this, interval]()
+      {
+        std::unique_lock<std::mutex> lock{mutex_};
+        while (!signal_.wait_for(lock, interval, [&]() { return stopping_; }))
+        {
+          save();
+        }
+        save();
+      });
+}
+
+void metrics::write(std::ostream &os) const
+{
+  auto describe = [&](const char *name, const char *type, const char *help)
+  { os << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n'; };
+  describe("clock_redraw_seconds", "histogram", "Time to lay out and rasterize a frame.");
+  redraw.write(os, "clock_redraw_seconds");
+  describe("clock_tick_to_present_seconds", "histogram", "Time from a second boundary to the present of its frame.");
+  tick_to_present.write(os, "clock_tick_to_present_seconds");
+  describe("clock_font_opens_total", "counter", "Font faces opened at a new size.");
+  os << "clock_font_opens_total " << font_opens.value() << '\n';
+  describe("clock_text_bytes_total", "counter", "Bytes of text surfaces rasterized, all uploaded as textures.");
+  os << "clock_text_bytes_total " << text_bytes.value() << '\n';
+  describe("clock_audio_callback_seconds", "histogram", "Time spent mixing one audio buffer.");
+  audio_callback.write(os, "clock_audio_callback_seconds");
+  describe("clock_audio_underruns_total", "counter", "Audio callbacks that came late.");
+  os << "clock_audio_underruns_total " << audio_underruns.value() << '\n';
+  describe("clock_audio_voices", "gauge", "Voices mixed into the last audio buffer.");
+  os << "clock_audio_voices " << audio_voices.value() << '\n';
+  describe("clock_config_reloads_total", "counter", "Reads of the configuration file.");
+  os << "clock_config_reloads_total " << config_reloads.value() << '\n';
+  describe("clock_config_parse_seconds", "histogram", "Time to read and apply the configuration.");
+  config_parse.write(os, "clock_config_parse_seconds");
+  describe("clock_next_alarm_lead_seconds", "gauge", "Time until the next alarm, -1 when there is none.");
+  os << "clock_next_alarm_lead_seconds " << next_alarm_lead.value() << '\n';
+  describe("clock_suspended_seconds", "histogram", "Periods without any visible window, when nothing is drawn.");
+  suspended.write(os, "clock_suspended_seconds");
+  describe("clock_transition_frame_seconds", "histogram", "Time to draw a frame of a digit transition, before presenting it.");
+  transition_frame.write(os, "clock_transition_frame_seconds");
+  describe("clock_transition_late_frames_total", "counter", "Digit transition frames presented more than a refresh late.");
+  os << "clock_transition_late_frames_total " << transition_late_frames.value() << '\n';
+}
+
+void metrics::save()
+{
+  // Written beside the target and renamed over it, so a scraper never sees
+  // a partial file.
+  auto temporary = path_ + ".tmp";
+  {
+    std::ofstream file{temporary, std::ios::trunc};
+    write(file);
+    if (!file)
+    {
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path_, error);
+}
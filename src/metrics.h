@@ -0,0 +1,90 @@
+#ifndef SRC_METRICS_H
+#define SRC_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#define HISTOGRAM_BUCKETS 14
+
+// Updates are single relaxed atomic operations, so they are safe from any
+// thread, including the audio callback, and never allocate or block.
+class counter
+{
+private:
+  std::atomic<std::uint64_t> value_;
+
+public:
+  counter();
+  void add(std::uint64_t amount = 1);
+  std::uint64_t value() const;
+};
+
+class gauge
+{
+private:
+  std::atomic<std::int64_t> value_;
+
+public:
+  gauge();
+  void set(std::int64_t value);
+  std::int64_t value() const;
+};
+
+class histogram
+{
+private:
+  // Upper bounds in microseconds; the last bucket is +Inf.
+  static constexpr std::array<std::int64_t, HISTOGRAM_BUCKETS - 1> bounds_ = {
+      50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000,
+      1000000};
+  std::array<std::atomic<std::uint64_t>, HISTOGRAM_BUCKETS> buckets_;
+  std::atomic<std::uint64_t> sum_;
+
+public:
+  histogram();
+  void observe(std::chrono::steady_clock::duration duration);
+  void write(std::ostream &os, const char *name) const;
+};
+
+class metrics
+{
+public:
+  histogram redraw;
+  histogram tick_to_present;
+  counter font_opens;
+  counter text_bytes;
+  histogram audio_callback;
+  counter audio_underruns;
+  gauge audio_voices;
+  counter config_reloads;
+  histogram config_parse;
+  gauge next_alarm_lead;
+  histogram suspended;
+  histogram transition_frame;
+  counter transition_late_frames;
+
+private:
+  std::string path_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable signal_;
+  bool stopping_;
+
+public:
+  metrics();
+  ~metrics();
+  void start(const std::string &path, std::chrono::seconds interval);
+  void write(std::ostream &os) const;
+
+private:
+  void save();
+};
+
+#endif // SRC_METRICS_H
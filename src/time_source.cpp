@@ -0,0 +1,43 @@
+#include "time_source.h"
+
+time_source::time_source()
+    : simulated_{false},
+      wall_{},
+      steady_{}
+{
+}
+
+time_source::~time_source() {}
+
+void time_source::simulate(std::chrono::system_clock::time_point from)
+{
+  simulated_ = true;
+  wall_ = from;
+  steady_ = std::chrono::steady_clock::now();
+}
+
+bool time_source::simulated() const { return simulated_; }
+
+std::chrono::system_clock::time_point time_source::now() const
+{
+  return simulated_ ? wall_ : std::chrono::system_clock::now();
+}
+
+std::chrono::steady_clock::time_point time_source::steady() const
+{
+  return simulated_ ? steady_ : std::chrono::steady_clock::now();
+}
+
+void time_source::advance(std::chrono::system_clock::duration duration)
+{
+  wall_ += duration;
+  steady_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      duration);
+}
+
+void time_source::set(std::chrono::system_clock::time_point wall,
+                      std::chrono::steady_clock::time_point steady)
+{
+  wall_ = wall;
+  steady_ = steady;
+}
@@ -0,0 +1,28 @@
+#ifndef SRC_TIME_SOURCE_H
+#define SRC_TIME_SOURCE_H
+
+#include <chrono>
+
+// Where the clock reads the time. Normally that is the system and steady
+// clocks; a simulation instead starts both at a given wall time and moves
+// them forward only when told to.
+class time_source
+{
+private:
+  bool simulated_;
+  std::chrono::system_clock::time_point wall_;
+  std::chrono::steady_clock::time_point steady_;
+
+public:
+  time_source();
+  ~time_source();
+  void simulate(std::chrono::system_clock::time_point from);
+  bool simulated() const;
+  std::chrono::system_clock::time_point now() const;
+  std::chrono::steady_clock::time_point steady() const;
+  void advance(std::chrono::system_clock::duration duration);
+  void set(std::chrono::system_clock::time_point wall,
+           std::chrono::steady_clock::time_point steady);
+};
+
+#endif // SRC_TIME_SOURCE_H
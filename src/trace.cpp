@@ -0,0 +1,124 @@
+#include "trace.h"
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+  struct EVENT
+  {
+    const char *name;
+    std::int64_t begin;
+    std::int64_t end;
+  };
+
+  struct RING
+  {
+    int tid;
+    const char *name;
+    std::uint64_t count;
+    std::array<EVENT, TRACE_CAPACITY> events;
+  };
+
+  std::chrono::steady_clock::time_point epoch;
+  std::mutex rings_mutex;
+  std::vector<std::unique_ptr<RING>> rings;
+  std::vector<std::unique_ptr<RING>> spares;
+  thread_local RING *ring = nullptr;
+  thread_local const char *thread_name = nullptr;
+
+  std::int64_t since_epoch(std::chrono::steady_clock::time_point time)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch)
+        .count();
+  }
+}
+
+void trace::enable()
+{
+  epoch = std::chrono::steady_clock::now();
+  enabled_ = true;
+}
+
+void trace::name_thread(const char *name)
+{
+  thread_name = name;
+  if (ring)
+  {
+    ring->name = name;
+  }
+}
+
+void trace::reserve()
+{
+  // A ring for a thread about to start that must not allocate once it runs,
+  // like the audio callback, which holds the audio lock.
+  if (!enabled_)
+  {
+    return;
+  }
+  auto spare = std::make_unique<RING>();
+  std::lock_guard<std::mutex> lock{rings_mutex};
+  spares.push_back(std::move(spare));
+  rings.reserve(rings.size() + spares.size());
+}
+
+void trace::record(const char *name,
+                   std::chrono::steady_clock::time_point begin,
+                   std::chrono::steady_clock::time_point end)
+{
+  if (!ring)
+  {
+    std::lock_guard<std::mutex> lock{rings_mutex};
+    if (!spares.empty())
+    {
+      rings.push_back(std::move(spares.back()));
+      spares.pop_back();
+    }
+    else
+    {
+      rings.push_back(std::make_unique<RING>());
+    }
+    ring = rings.back().get();
+    ring->tid = rings.size();
+    ring->name = thread_name;
+    ring->count = 0;
+  }
+  ring->events[ring->count++ % TRACE_CAPACITY] = {name, since_epoch(begin),
+                                                  since_epoch(end)};
+}
+
+void trace::dump(const std::string &path)
+{
+  std::ofstream file{path, std::ios::trunc};
+  std::lock_guard<std::mutex> lock{rings_mutex};
+  file << "{\"traceEvents\":[\n";
+  bool first = true;
+  auto separate = [&]()
+  {
+    file << (first ? "" : ",\n");
+    first = false;
+  };
+  for (const auto &ring : rings)
+  {
+    separate();
+    file << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+         << ring->tid << ",\"args\":{\"name\":\""
+         << (ring->name ? ring->name : "thread") << "\"}}";
+    auto begin = ring->count > TRACE_CAPACITY ? ring->count - TRACE_CAPACITY : 0;
+    for (auto i = begin; i < ring->count; ++i)
+    {
+      const auto &event = ring->events[i % TRACE_CAPACITY];
+      separate();
+      file << "{\"ph\":\"X\",\"name\":\"" << event.name
+           << "\",\"pid\":1,\"tid\":" << ring->tid
+           << ",\"ts\":" << event.begin / 1000 << '.' << event.begin / 100 % 10
+           << ",\"dur\":" << (event.end - event.begin) / 1000 << '.'
+           << (event.end - event.begin) / 100 % 10 << '}';
+    }
+  }
+  file << "\n]}\n";
+}
@@ -0,0 +1,58 @@
+#ifndef SRC_TRACE_H
+#define SRC_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#define TRACE_CAPACITY 16384
+
+// Records scoped spans into a ring buffer per thread and writes them in the
+// Chrome trace-event format. While tracing is off a span costs one branch.
+class trace
+{
+public:
+  class span
+  {
+  private:
+    const char *name_;
+    std::chrono::steady_clock::time_point begin_;
+
+  public:
+    explicit span(const char *name) : name_{nullptr}, begin_{}
+    {
+      if (enabled_)
+      {
+        name_ = name;
+        begin_ = std::chrono::steady_clock::now();
+      }
+    }
+
+    ~span()
+    {
+      if (name_)
+      {
+        record(name_, begin_, std::chrono::steady_clock::now());
+      }
+    }
+
+    span(const span &) = delete;
+    span &operator=(const span &) = delete;
+  };
+
+private:
+  inline static bool enabled_ = false;
+
+public:
+  static void enable();
+  static void name_thread(const char *name);
+  static void reserve();
+  static void dump(const std::string &path);
+
+private:
+  static void record(const char *name,
+                     std::chrono::steady_clock::time_point begin,
+                     std::chrono::steady_clock::time_point end);
+};
+
+#endif // SRC_TRACE_H
@@ -0,0 +1,46 @@
+#ifndef SRC_TRIPLE_BUFFER_H
+#define SRC_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+
+// One writer fills back() and publishes it; one reader takes the newest
+// published slot with update() and keeps reading front() until the next one.
+// Neither side ever waits for the other.
+template <typename T>
+class triple_buffer
+{
+private:
+  static constexpr int FRESH = 4;
+  std::array<T, 3> slots_;
+  std::atomic<int> middle_;
+  int back_;
+  int front_;
+
+public:
+  triple_buffer()
+      : slots_{},
+        middle_{1},
+        back_{0},
+        front_{2}
+  {
+  }
+
+  T &back() { return slots_[back_]; }
+
+  void publish() { back_ = middle_.exchange(back_ | FRESH) & ~FRESH; }
+
+  bool update()
+  {
+    if ((middle_.load() & FRESH) == 0)
+    {
+      return false;
+    }
+    front_ = middle_.exchange(front_) & ~FRESH;
+    return true;
+  }
+
+  const T &front() const { return slots_[front_]; }
+};
+
+#endif // SRC_TRIPLE_BUFFER_H
@@ -2,39 +2,80 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
 #include <iomanip>
-#include <numeric>
+#include <limits>
 #include <sstream>
 #include <string>
 
-#include "resources.h"
-
 void play_audio(void *pData, unsigned char *pBuffer, int Length)
 {
   ((wall_clock *)pData)->play_chimes(pBuffer, Length);
 }
 
-wall_clock::wall_clock(const std::string &help_path)
+wall_clock::wall_clock(const std::string &help_path, const OPTIONS &options)
     : help_path_{help_path},
-      wnd_{nullptr},
-      renderer_{nullptr},
-      font_source_{nullptr},
-      font_big_{nullptr},
-      font_medium_{nullptr},
-      font_small_{nullptr},
-      width_{0},
-      height_{0},
-      digit_width_{0},
-      colon_width_{0},
-      ampm_width_{0},
-      time_width_{0},
-      lines_height_{0},
+      options_{options},
+      metrics_{},
+      clock_{},
+      started_{false},
+      stage_time_{std::chrono::steady_clock::now()},
+      stages_{},
       frame_time_{},
-      timer_base_{},
+      timers_{},
+      current_timer_{0},
+      timer_serial_{0},
+      stopwatch_running_{false},
+      stopwatch_start_{},
+      stopwatch_elapsed_{},
+      laps_{},
+      lap_total_{},
+      lap_count_{0},
+      steady_time_{},
+      wall_reference_{},
+      steady_reference_{},
       now_{0},
+      screens_{},
+      frames_{},
+      frame_event_{0},
+      control_{},
+      running_{true},
+      error_{},
+      events_{},
+      command_event_{0},
+      socket_{},
+      present_latency_{0},
+      distance_blending_{true},
+      fonts_{&metrics_.font_opens},
+      recording_{},
+      replay_{},
+      prepared_{},
+      command_received_{},
+      command_latency_{},
+      added_alarms_{},
+      removed_alarms_{},
+      lines_height_{0},
+      rows_{},
+      suspended_since_{},
+      audio_device_{0},
+      audio_spec_{},
+      sample_rate_{SEGMENT_COUNT * SAMPLE_COUNT},
+      buffer_size_{SAMPLE_COUNT},
+      chime_rate_{SEGMENT_COUNT * SAMPLE_COUNT},
+      audio_rate_{SEGMENT_COUNT * SAMPLE_COUNT},
+      audio_buffer_{SAMPLE_COUNT},
+      font_path_{},
+      audio_stats_{},
+      audio_clock_{0},
+      audio_time_{},
+      audio_idle_{true},
+      bank_{},
+      chimes_{},
+      chime_sequence_{-1, {}, nullptr},
+      alarm_sequence_{-1, {}, nullptr},
       tense_{0},
       pitch_{0},
       volume_{0},
@@ -48,8 +89,21 @@ wall_clock::wall_clock(const std::string &help_path)
       has_chimes_{false},
       has_alarms_{false},
       has_sound_info_{true},
+      debug_{false},
+      transition_{TRANSITION_NONE},
+      analog_{false},
+      sweep_{false},
+      pixel_shift_{0},
+      max_glyph_size_{0},
+      sdf_{false},
+      distance_{},
+      distance_font_{},
+      distance_job_{},
       weekday_{},
       date_{},
+      layout_{},
+      weekday_format_{},
+      date_format_{},
       time_24_{true},
       seconds_{true},
       pad_hour_{true},
@@ -59,23 +113,28 @@ wall_clock::wall_clock(const std::string &help_path)
       pad_month_{true},
       pad_day_{true},
       timer_interval_{0},
-      next_alarm_{std::size_t(-1)},
-      audio_device_{0},
-      texture_second_{nullptr},
-      size_second_{0, 0},
-      texture_ampm_{nullptr},
-      size_ampm_{0, 0},
-      texture_time_{nullptr},
-      size_time_{0, 0},
-      texture_weekday_{nullptr},
-      size_weekday_{0, 0},
-      texture_date_{nullptr},
-      size_date_{0, 0},
-      texture_options_{nullptr},
-      size_options_{0, 0},
-      total_height_{0}
-{
-  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
+      fire_missed_alarms_{true},
+      next_alarm_{std::size_t(-1)}
+{
+  if (!options_.trace.empty())
+  {
+    trace::enable();
+  }
+  if (options_.simulate)
+  {
+    clock_.simulate(options_.simulate_from);
+  }
+  else if (!options_.replay.empty())
+  {
+    replay_.open(options_.replay);
+    clock_.simulate(replay_.start());
+  }
+  if (!options_.record.empty())
+  {
+    recording_.create(options_.record, clock_.now(), clock_.steady());
+  }
+  chime_bank_ = std::async(std::launch::async, chime_bank::load);
+  if (SDL_Init(options_.simulate ? 0 : SDL_INIT_VIDEO) < 0)
   {
     throw std::runtime_error("SDL_INIT");
   }
@@ -84,368 +143,1247 @@ wall_clock::wall_clock(const std::string &help_path)
     throw std::runtime_error("TTF_Init");
   }
   SDL_SetHint(SDL_HINT_VIDEO_MINIMIZE_ON_FOCUS_LOSS, "0");
-  wnd_ = SDL_CreateWindow("Wall Clock", SDL_WINDOWPOS_UNDEFINED,
-                          SDL_WINDOWPOS_UNDEFINED, 800, 600,
-                          SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
-  if (!wnd_)
+  // A simulation runs without any window.
+  if (options_.all_displays && !options_.simulate)
   {
-    throw std::runtime_error("SDL_create_window");
+    auto count = SDL_GetNumVideoDisplays();
+    if (count < 1)
+    {
+      throw std::runtime_error("SDL_GetNumVideoDisplays");
+    }
+    for (int display = 0; display < count; ++display)
+    {
+      create_screen(display, display == 0);
+    }
   }
-  renderer_ = SDL_CreateRenderer(
-      wnd_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-  if (!renderer_)
+  else if (!options_.simulate)
   {
-    throw std::runtime_error("SDL_CreateRenderer");
+    create_screen(-1, true);
+  }
+  frame_event_ = SDL_RegisterEvents(2);
+  if (frame_event_ == Uint32(-1))
+  {
+    throw std::runtime_error("SDL_RegisterEvents");
+  }
+  command_event_ = frame_event_ + 1;
+  if (!options_.metrics.empty())
+  {
+    metrics_.start(options_.metrics, std::chrono::seconds(METRICS_INTERVAL));
   }
-  font_source_ = SDL_RWFromConstMem(Font_ttf, Font_ttf_size);
-  if (!font_source_)
+  if (!options_.control_socket.empty())
   {
-    throw std::runtime_error("SDL_RWFromConstMem");
+    socket_ = std::make_unique<control_socket>(options_.control_socket,
+                                               command_event_);
   }
-  std::vector<int> sequence(13);
-  std::iota(sequence.begin(), sequence.end(), 0);
-  chimes_.insert(chimes_.end(), sequence.begin(), sequence.end());
-  create_audio();
+  stage("window");
   set_config_handlers();
-  set_display();
+  for (auto &screen : screens_)
+  {
+    set_display(*screen, screen->display >= 0 ? screen->display : display_,
+                fullscreen_);
+  }
+  set_fonts();
+  stage("big font");
 }
 
 wall_clock::~wall_clock()
 {
-  SDL_CloseAudioDevice(audio_device_);
-  TTF_CloseFont(font_big_);
-  TTF_CloseFont(font_medium_);
-  TTF_CloseFont(font_small_);
+  socket_.reset();
+  if (control_.joinable())
+  {
+    {
+      // Under the lock, so the control thread cannot miss the wake-up
+      // between checking running_ and waiting.
+      std::lock_guard<std::mutex> lock{event_mutex_};
+      running_ = false;
+    }
+    event_signal_.notify_all();
+    control_.join();
+  }
+  for (const auto &event : events_)
+  {
+    if (event.type == command_event_)
+    {
+      delete static_cast<control_socket::COMMAND *>(event.user.data1);
+    }
+  }
+  if (chime_bank_.valid())
+  {
+    chime_bank_.wait();
+  }
+  if (distance_job_.valid())
+  {
+    distance_job_.wait();
+  }
+  close_audio();
+  if (!options_.trace.empty())
+  {
+    trace::dump(options_.trace);
+  }
+  if (debug_ || !options_.trace.empty())
+  {
+    report_audio(std::clog);
+    std::clog << std::endl;
+  }
+  fonts_.clear();
   TTF_Quit();
-  SDL_RWclose(font_source_);
-  SDL_DestroyRenderer(renderer_);
-  SDL_DestroyWindow(wnd_);
+  for (const auto &screen : screens_)
+  {
+    for (const auto &[surface, texture] : screen->textures)
+    {
+      SDL_DestroyTexture(texture);
+    }
+    for (const auto texture : {screen->dial, screen->text[0], screen->text[1]})
+    {
+      if (texture)
+      {
+        SDL_DestroyTexture(texture);
+      }
+    }
+    SDL_DestroyRenderer(screen->renderer);
+    SDL_DestroyWindow(screen->window);
+  }
   SDL_Quit();
 }
 
-void wall_clock::set_display()
+void wall_clock::start()
 {
-  if (display_ >= 0 && display_ != SDL_GetWindowDisplayIndex(wnd_))
+  started_ = true;
+  set_fonts();
+  stage("fonts");
+  bank_ = chime_bank_.get();
+  chimes_ = bank_;
+  stage("chimes");
+  if (!clock_.simulated())
   {
-    if ((SDL_GetWindowFlags(wnd_) & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP)
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
     {
-      SDL_SetWindowFullscreen(wnd_, 0);
+      throw std::runtime_error("SDL_INIT(audio)");
     }
-    SDL_Rect current_frame;
-    if (SDL_GetDisplayUsableBounds(SDL_GetWindowDisplayIndex(wnd_), &current_frame) != 0)
+    create_audio();
+    stage("audio");
+  }
+  if (options_.startup_trace)
+  {
+    std::chrono::steady_clock::duration total{};
+    for (const auto &[name, duration] : stages_)
     {
-      throw std::runtime_error("SDL_GetDisplayUsableBounds(current)");
+      total += duration;
+      std::cout << "Startup: " << name << " "
+                << std::chrono::duration<float, std::milli>(duration).count()
+                << " ms (" << std::chrono::duration<float, std::milli>(total).count()
+                << " ms)" << std::endl;
     }
-    SDL_Rect current_window;
-    SDL_GetWindowPosition(wnd_, &current_window.x, &current_window.y);
-    SDL_GetWindowSize(wnd_, &current_window.w, &current_window.h);
-    SDL_Rect new_frame;
-    if (SDL_GetDisplayUsableBounds(display_, &new_frame) != 0)
+  }
+}
+
+void wall_clock::simulate()
+{
+  // Tick once per simulated second as fast as possible, and mix whatever is
+  // ringing one second at a time, as the audio device would.
+  trace::name_thread("control");
+  start();
+  frame_time_ = clock_.now();
+  auto now = std::chrono::system_clock::to_time_t(frame_time_);
+  now_ = *std::localtime(&now);
+  update_tense();
+  read_config();
+  audio_time_ = clock_.steady();
+  auto begin = std::chrono::steady_clock::now();
+  while (clock_.now() < options_.simulate_to)
+  {
+    frame_time_ = clock_.now();
+    steady_time_ = clock_.steady();
+    tick();
+    clock_.advance(std::chrono::seconds(1));
+    mix_audio();
+  }
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - begin)
+                     .count();
+  auto days = std::chrono::duration<double, std::ratio<24 * 60 * 60>>(
+                  options_.simulate_to - options_.simulate_from)
+                  .count();
+  std::cout << "Simulated " << days << " days in " << elapsed << " s, "
+            << days / elapsed << " days per second" << std::endl;
+}
+
+void wall_clock::replay()
+{
+  // Feed the recording back through tick() and handle_event() on the virtual
+  // clock, at the recorded pace unless asked to hurry, and print how long
+  // the control thread took over each record.
+  auto origin = std::chrono::steady_clock::now();
+  auto base = clock_.steady();
+  std::map<std::string, std::vector<std::int64_t>> timings;
+  std::size_t index = 0;
+  event_log::RECORD record;
+  while (running_ && replay_.read(record))
+  {
+    auto offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds{record.steady});
+    auto deadline = options_.fast ? std::chrono::steady_clock::time_point{}
+                                  : origin + offset;
+    SDL_Event live;
+    while (wait_event(live, deadline))
     {
-      throw std::runtime_error("SDL_GetWindowDisplayIndex(new)");
+      if (live.type == command_event_)
+      {
+        std::unique_ptr<control_socket::COMMAND> command{
+            static_cast<control_socket::COMMAND *>(live.user.data1)};
+        control_socket::reply(*command, "ERR replaying");
+      }
+      else if (live.type == SDL_QUIT ||
+               (live.type == SDL_WINDOWEVENT &&
+                live.window.event == SDL_WINDOWEVENT_CLOSE))
+      {
+        return;
+      }
     }
-    SDL_Rect new_window{
-        new_frame.x + (current_window.x - current_frame.x) * new_frame.w / current_frame.w,
-        new_frame.y + (current_window.y - current_frame.y) * new_frame.h / current_frame.h,
-        current_window.w * new_frame.w / current_frame.w,
-        current_window.h * new_frame.h / current_frame.h,
-    };
-    SDL_SetWindowPosition(wnd_, new_window.x, new_window.y);
-    SDL_SetWindowSize(wnd_, new_window.w, new_window.h);
+    clock_.set(std::chrono::system_clock::time_point{
+                   std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                       std::chrono::nanoseconds{record.wall})},
+               base + offset);
+    const char *kind = "tick";
+    auto begin = std::chrono::steady_clock::now();
+    if (record.type == 0)
+    {
+      frame_time_ = clock_.now();
+      steady_time_ = clock_.steady();
+      tick();
+      mix_audio();
+    }
+    else
+    {
+      SDL_Event event{};
+      event.type = record.type;
+      if (record.type == SDL_WINDOWEVENT)
+      {
+        kind = "window";
+        event.window.event = record.code;
+        event.window.windowID =
+            screens_[std::min<std::size_t>(record.screen, screens_.size() - 1)]
+                ->window_id;
+        event.window.data1 = record.data1;
+        event.window.data2 = record.data2;
+      }
+      else if (record.type == SDL_KEYUP || record.type == SDL_KEYDOWN)
+      {
+        kind = "key";
+        event.key.keysym.scancode = SDL_Scancode(record.code);
+      }
+      else
+      {
+        kind = "event";
+      }
+      if (handle_event(&event) < 0)
+      {
+        break;
+      }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+    std::cout << index++ << " " << kind << " " << elapsed << "\n";
+    timings[kind].push_back(elapsed);
+  }
+  for (auto &[kind, times] : timings)
+  {
+    std::sort(times.begin(), times.end());
+    std::cout << "Replay: " << kind << " " << times.size() << " records, us p50 "
+              << times[times.size() / 2] << " p99 "
+              << times[times.size() * 99 / 100] << " max " << times.back()
+              << std::endl;
   }
-  set_window();
 }
 
-void wall_clock::set_window()
+void wall_clock::record_event(const SDL_Event &event)
 {
-  if (fullscreen_)
+  if (!recording_.is_open() || event.type == command_event_)
   {
-    if ((SDL_GetWindowFlags(wnd_) & SDL_WINDOW_FULLSCREEN_DESKTOP) != SDL_WINDOW_FULLSCREEN_DESKTOP)
+    return;
+  }
+  std::uint32_t screen = 0;
+  std::int32_t code = 0, data1 = 0, data2 = 0;
+  if (event.type == SDL_WINDOWEVENT)
+  {
+    for (std::size_t i = 0; i < screens_.size(); ++i)
     {
-      if (SDL_SetWindowFullscreen(wnd_, SDL_WINDOW_FULLSCREEN_DESKTOP) != 0)
+      if (screens_[i]->window_id == event.window.windowID)
       {
-        throw std::runtime_error("SDL_SetWindowFullscreen(true)");
+        screen = i;
       }
     }
+    code = event.window.event;
+    data1 = event.window.data1;
+    data2 = event.window.data2;
   }
-  else
+  else if (event.type == SDL_KEYUP || event.type == SDL_KEYDOWN)
+  {
+    code = event.key.keysym.scancode;
+  }
+  recording_.event(clock_.now(), clock_.steady(), event.type, code, screen,
+                   data1, data2);
+}
+
+void wall_clock::mix_audio()
+{
+  // Without an audio device, mix one second of whatever is ringing in its
+  // place after each simulated tick.
+  if (audio_idle_ && strikes_.empty())
+  {
+    return;
+  }
+  std::vector<float> buffer(sample_rate_);
+  play_chimes(reinterpret_cast<unsigned char *>(buffer.data()),
+              buffer.size() * sizeof(float));
+}
+
+void wall_clock::stage(const char *name)
+{
+  auto now = std::chrono::steady_clock::now();
+  stages_.emplace_back(name, now - stage_time_);
+  stage_time_ = now;
+}
+
+void wall_clock::first_frame()
+{
+  auto now = std::chrono::system_clock::to_time_t(clock_.now());
+  now_ = *std::localtime(&now);
+  update_tense();
+  read_config();
+  stage("config");
+  for (auto &screen : screens_)
+  {
+    if (set_display(*screen,
+                    screen->display >= 0 ? screen->display : display_,
+                    fullscreen_))
+    {
+      set_fonts(*screen);
+    }
+  }
+  auto time = format_time(now_);
+  auto &frames = frames_.back();
+  frames.resize(screens_.size());
+  for (std::size_t i = 0; i < screens_.size(); ++i)
+  {
+    auto &screen = *screens_[i];
+    draw_text(screen.line_time, time, screen.font_big, screen.scale_big);
+    auto &frame = begin_frame(screen, frames[i]);
+    frame.background.a = 255;
+    frame.lines.push_back(
+        {screen.line_time.surface,
+         {(screen.width - screen.line_time.size.x) / 2,
+          (screen.height - screen.line_time.size.y) / 2,
+          screen.line_time.size.x, screen.line_time.size.y},
+         frame.distance ? time : "",
+         frame.distance ? screen.line_time.size.y /
+                              float(frame.distance->measure("").y)
+                        : 0.0f});
+  }
+  frames_.publish();
+  adopt();
+  for (auto &screen : screens_)
+  {
+    compose(*screen);
+  }
+}
+
+void wall_clock::control()
+{
+  trace::name_thread("control");
+  try
   {
-    if ((SDL_GetWindowFlags(wnd_) & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP)
+    start();
+    if (replay_.is_open())
     {
-      if (SDL_SetWindowFullscreen(wnd_, 0) != 0)
+      replay();
+    }
+    while (running_ && !replay_.is_open())
+    {
+      auto now = clock_.now();
+      auto tmp = now.time_since_epoch().count() %
+                 std::chrono::system_clock::period::den;
+      now = now - std::chrono::system_clock::duration{tmp};
+      if (now != frame_time_)
       {
-        throw std::runtime_error("SDL_SetWindowFullscreen(false)");
+        frame_time_ = now;
+        steady_time_ = clock_.steady();
+        if (recording_.is_open())
+        {
+          recording_.tick(frame_time_, steady_time_);
+        }
+        tick();
+      }
+      else
+      {
+        // Wait for the rest of the second on the steady clock, so a step of
+        // the wall clock cannot stretch the wait.
+        SDL_Event event;
+        if (wait_event(event, std::chrono::steady_clock::now() +
+                                  (now + std::chrono::seconds(1) -
+                                   clock_.now())))
+        {
+          record_event(event);
+          if (handle_event(&event) < 0)
+          {
+            break;
+          }
+        }
       }
     }
   }
-  SDL_GetWindowSizeInPixels(wnd_, &width_, &height_);
-  if (SDL_RenderSetLogicalSize(renderer_, width_, height_) != 0)
+  catch (...)
   {
-    throw std::runtime_error("SDL_RenderSetLogicalSize");
+    error_ = std::current_exception();
   }
-  set_fonts();
+  running_ = false;
+  SDL_Event wake{};
+  wake.type = frame_event_;
+  SDL_PushEvent(&wake);
 }
 
-void wall_clock::set_fonts()
+bool wall_clock::wait_event(SDL_Event &event,
+                            std::chrono::steady_clock::time_point deadline)
 {
-  lines_height_ = calculate_lines_height();
-  reset_big_font();
-  auto text_width = std::max(digit_width_ * 6 + colon_width_ * 2, width_);
-  SDL_RWseek(font_source_, 0, RW_SEEK_SET);
-  TTF_CloseFont(font_medium_);
-  font_medium_ = TTF_OpenFontRW(font_source_, false,
-                                width_ * height_ * 2 / lines_height_ / text_width);
-  if (!font_medium_)
+  std::unique_lock<std::mutex> lock{event_mutex_};
+  if (!event_signal_.wait_until(lock, deadline, [&]()
+                                { return !events_.empty() || !running_; }) ||
+      events_.empty())
+  {
+    return false;
+  }
+  event = events_.front();
+  events_.pop_front();
+  return true;
+}
+
+void wall_clock::create_screen(int display, bool vsync)
+{
+  // Presenting waits for the vertical blank of each renderer that asks for
+  // it in turn, so only the first screen paces the render loop.
+  auto position = display >= 0 ? SDL_WINDOWPOS_UNDEFINED_DISPLAY(display)
+                               : SDL_WINDOWPOS_UNDEFINED;
+  screens_.push_back(std::make_unique<SCREEN>());
+  auto &screen = *screens_.back();
+  screen.display = display;
+  screen.frame_interval = 1000 / 60;
+  screen.window = SDL_CreateWindow("Wall Clock", position, position, 800, 600,
+                                   SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+  if (!screen.window)
   {
-    throw std::runtime_error("TTF_OpenFont");
+    throw std::runtime_error("SDL_create_window");
   }
-  SDL_RWseek(font_source_, 0, RW_SEEK_SET);
-  TTF_CloseFont(font_small_);
-  font_small_ = TTF_OpenFontRW(font_source_, false,
-                               width_ * height_ * 1 / lines_height_ / text_width);
-  if (!font_small_)
+  screen.window_id = SDL_GetWindowID(screen.window);
+  screen.renderer = SDL_CreateRenderer(
+      screen.window, -1,
+      SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+  if (!screen.renderer)
   {
-    throw std::runtime_error("TTF_OpenFont");
+    throw std::runtime_error("SDL_CreateRenderer");
   }
-  int space_width, a_width, p_width, m_width;
-  if (TTF_SizeText(font_medium_, " ", &space_width, nullptr) < 0 ||
-      TTF_SizeText(font_medium_, "A", &a_width, nullptr) < 0 ||
-      TTF_SizeText(font_medium_, "P", &p_width, nullptr) < 0 ||
-      TTF_SizeText(font_medium_, "M", &m_width, nullptr) < 0)
+  // Renderers without custom blend modes, like the software one, cannot cut
+  // a distance field; then the text stays rasterized.
+  for (auto mode : distance_blend_modes())
   {
-    throw std::runtime_error("TTF_SizeText");
+    if (SDL_SetRenderDrawBlendMode(screen.renderer, mode) != 0)
+    {
+      distance_blending_ = false;
+    }
   }
-  ampm_width_ = space_width + std::max(a_width, p_width) + m_width;
-  set_big_font();
+  SDL_SetRenderDrawBlendMode(screen.renderer, SDL_BLENDMODE_NONE);
 }
 
-void wall_clock::reset_big_font()
+wall_clock::SCREEN *wall_clock::find_screen(Uint32 window_id)
 {
-  SDL_RWseek(font_source_, 0, RW_SEEK_SET);
-  TTF_CloseFont(font_big_);
-  font_big_ = TTF_OpenFontRW(font_source_, false, height_ * 4 / lines_height_);
-  if (!font_big_)
+  for (const auto &screen : screens_)
   {
-    throw std::runtime_error("TTF_OpenFont");
+    if (screen->window_id == window_id)
+    {
+      return screen.get();
+    }
   }
-  if (TTF_SizeText(font_big_, "0", &digit_width_, nullptr) < 0 ||
-      TTF_SizeText(font_big_, ":", &colon_width_, nullptr) < 0)
+  return nullptr;
+}
+
+void wall_clock::forward(const SDL_Event &event)
+{
+  if (event.type == SDL_RENDER_TARGETS_RESET)
   {
-    throw std::runtime_error("TTF_SizeText");
+    // The dials and the text drawn into textures are lost.
+    for (auto &screen : screens_)
+    {
+      screen->dial_face.reset();
+      if (!screen->hidden)
+      {
+        if (screen->frame.distance)
+        {
+          draw_distance(*screen);
+        }
+        compose(*screen);
+      }
+    }
+    return;
+  }
+  if (event.type == SDL_WINDOWEVENT &&
+      event.window.event == SDL_WINDOWEVENT_RESIZED)
+  {
+    auto screen = find_screen(event.window.windowID);
+    if (screen)
+    {
+      resize(*screen);
+    }
+    return;
   }
-  time_width_ = calculate_time_width();
+  if (event.type == SDL_WINDOWEVENT &&
+      (event.window.event == SDL_WINDOWEVENT_SHOWN ||
+       event.window.event == SDL_WINDOWEVENT_HIDDEN ||
+       event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+       event.window.event == SDL_WINDOWEVENT_MINIMIZED ||
+       event.window.event == SDL_WINDOWEVENT_MAXIMIZED ||
+       event.window.event == SDL_WINDOWEVENT_RESTORED))
+  {
+    // A window that comes back waits for the full redraw it asks for rather
+    // than showing the frame it was hidden with.
+    auto screen = find_screen(event.window.windowID);
+    if (screen && !update_visibility(*screen) && !screen->hidden &&
+        event.window.event == SDL_WINDOWEVENT_EXPOSED)
+    {
+      compose(*screen);
+    }
+    return;
+  }
+  queue(event);
 }
 
-void wall_clock::set_big_font()
+void wall_clock::queue(const SDL_Event &event)
 {
-  SDL_RWseek(font_source_, 0, RW_SEEK_SET);
-  TTF_CloseFont(font_big_);
-  font_big_ = TTF_OpenFontRW(font_source_, false,
-                             (width_ - ampm_width_) * height_ * 4 / lines_height_ /
-                                 (std::max(time_width_, width_) - ampm_width_));
-  if (!font_big_)
   {
-    throw std::runtime_error("TTF_OpenFont");
+    std::lock_guard<std::mutex> lock{event_mutex_};
+    events_.push_back(event);
   }
-  if (TTF_SizeText(font_big_, "0", &digit_width_, nullptr) < 0 ||
-      TTF_SizeText(font_big_, ":", &colon_width_, nullptr) < 0)
+  event_signal_.notify_one();
+}
+
+bool wall_clock::update_visibility(SCREEN &screen)
+{
+  // SDL 2 reports neither occlusion nor display power, so a window counts as
+  // hidden while it is hidden or minimized.
+  bool hidden = SDL_GetWindowFlags(screen.window) &
+                (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED);
+  if (hidden == screen.hidden)
   {
-    throw std::runtime_error("TTF_SizeText");
+    return false;
   }
-  time_width_ = calculate_time_width();
+  screen.hidden = hidden;
+  SDL_Event event{};
+  event.type = SDL_WINDOWEVENT;
+  event.window.event = hidden ? SDL_WINDOWEVENT_HIDDEN : SDL_WINDOWEVENT_SHOWN;
+  event.window.windowID = screen.window_id;
+  queue(event);
+  return true;
 }
 
-void wall_clock::create_audio()
+bool wall_clock::suspended()
 {
-  SDL_AudioSpec Alarm;
-  SDL_zero(Alarm);
-  Alarm.freq = SEGMENT_COUNT * SAMPLE_COUNT;
-  Alarm.format = AUDIO_F32SYS;
-  Alarm.channels = 1;
-  Alarm.samples = SAMPLE_COUNT;
-  Alarm.callback = play_audio;
-  Alarm.userdata = this;
-  audio_device_ = SDL_OpenAudioDevice(nullptr, 0, &Alarm, nullptr, 0);
-  if (!audio_device_)
+  return !screens_.empty() &&
+         std::all_of(screens_.begin(), screens_.end(),
+                     [](const auto &screen) { return screen->suspended; });
+}
+
+bool wall_clock::adopt()
+{
+  if (!frames_.update())
   {
-    throw std::runtime_error("SDL_create_audio");
+    return false;
+  }
+  const auto &frames = frames_.front();
+  for (std::size_t i = 0; i < screens_.size() && i < frames.size(); ++i)
+  {
+    if (!screens_[i]->hidden)
+    {
+      adopt(*screens_[i], frames[i]);
+    }
   }
+  return true;
 }
 
-void wall_clock::set_config_handlers()
+void wall_clock::adopt(SCREEN &screen, const FRAME &frame)
 {
-  config_handlers_ = {
-      {"alarm",
-       [&](std::istream &is)
-       {
-         char colon;
-         int hour, minute;
-         if (is >> hour >> colon >> minute)
-         {
-           if (colon == ':' && hour < 24 && hour >= 0 && minute < 60 &&
-               minute >= 0)
-           {
-             std::vector<std::size_t> alarm_weekdays;
-             std::string weekday;
-             bool inactive = false;
-             while (is >> weekday)
-             {
-               std::transform<std::string::iterator, std::string::iterator,
-                              int (*)(int)>(weekday.begin(), weekday.end(),
-                                            weekday.begin(), std::toupper);
-               if (weekday == "WEEKDAYS")
-               {
-                 for (const auto wd : {1, 2, 3, 4, 5})
-                 {
-                   alarm_weekdays.push_back(wd);
-                 }
-               }
-               else if (weekday == "WEEKEND")
-               {
-                 for (const auto wd : {0, 6})
-                 {
-                   alarm_weekdays.push_back(wd);
-                 }
-               }
-               else if (weekday == "NEVER")
-               {
-                 alarm_weekdays.clear();
-                 inactive = true;
-                 break;
-               }
-               else
-               {
-                 auto day =
-                     std::find(weekdays_full_.begin(), weekdays_full_.end(), weekday);
-                 if (day != weekdays_full_.end())
-                 {
-                   alarm_weekdays.push_back(day - weekdays_full_.begin());
-                 }
-               }
-             }
-             if (alarm_weekdays.empty() && !inactive)
-             {
-               for (auto it = weekdays_full_.begin(); it != weekdays_full_.end(); ++it)
-               {
-                 alarm_weekdays.push_back(it - weekdays_full_.begin());
-               }
-             }
-             for (const auto &alarm_weekday : alarm_weekdays)
-             {
-               alarms_.insert((alarm_weekday * 24 + hour) * 60 + minute);
-             }
-           }
-         }
-       }},
-      {"volume",
-       [&](std::istream &is)
-       {
-         int volume;
-         if (is >> volume && volume >= 0 && volume <= 100)
-         {
-           volume_ = volume;
-         }
-       }},
-      {"display",
-       [&](std::istream &is)
-       {
-         int display;
-         if (is >> display && display >= 0 &&
-             display <= SDL_GetNumVideoDisplays())
-         {
-           display_ = display - 1;
-         }
-       }},
-      {"color",
-       [&](std::istream &is)
-       {
-         int r, g, b;
-         if (is >> r >> g >> b)
-         {
-           text_color_.r = r;
-           text_color_.g = g;
-           text_color_.b = b;
-         }
-       }},
-      {"background",
-       [&](std::istream &is)
-       {
-         int r, g, b;
-         if (is >> r >> g >> b)
-         {
-           background_.r = r;
-           background_.g = g;
-           background_.b = b;
-         }
-       }},
-      {"hide-cursor",
-       [&](std::istream &is)
-       {
-         std::string hide_cursor;
-         if (is >> hide_cursor)
-         {
-           if (hide_cursor == "true")
-           {
-             hide_cursor_ = true;
-           }
-           else if (hide_cursor == "false")
-           {
-             hide_cursor_ = false;
-           }
-         }
-       }},
-      {"fullscreen",
+  auto now = std::chrono::steady_clock::now();
+  if (!screen.frame.width)
+  {
+    screen.fade_from = frame.alpha;
+  }
+  else if (frame.alpha != screen.frame.alpha)
+  {
+    screen.fade_from = fade(screen, now);
+    screen.fade_start = now;
+  }
+  if (frame.display != screen.frame.display ||
+      frame.fullscreen != screen.frame.fullscreen)
+  {
+    set_display(screen, frame.display, frame.fullscreen);
+  }
+  if (frame.hide_cursor != screen.frame.hide_cursor || !screen.frame.width)
+  {
+    SDL_ShowCursor(frame.hide_cursor ? SDL_DISABLE : SDL_ENABLE);
+  }
+  if ((frame.width != screen.frame.width ||
+       frame.height != screen.frame.height) &&
+      SDL_RenderSetLogicalSize(screen.renderer, frame.width, frame.height) != 0)
+  {
+    throw std::runtime_error("SDL_RenderSetLogicalSize");
+  }
+  // Keep the textures of surfaces the new frame still uses; the old frame is
+  // released only afterwards so no surface address can be reused meanwhile.
+  std::vector<std::pair<SDL_Surface *, SDL_Texture *>> textures;
+  auto keep = [&](SDL_Surface *surface)
+  {
+    if (!surface || std::any_of(textures.begin(), textures.end(),
+                                [&](const auto &cached)
+                                { return cached.first == surface; }))
+    {
+      return;
+    }
+    auto cached = std::find_if(screen.textures.begin(), screen.textures.end(),
+                               [&](const auto &cached)
+                               { return cached.first == surface; });
+    if (cached != screen.textures.end())
+    {
+      textures.push_back(*cached);
+      cached->second = nullptr;
+      return;
+    }
+    auto texture = SDL_CreateTextureFromSurface(screen.renderer, surface);
+    if (!texture ||
+        SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear) != 0)
+    {
+      throw std::runtime_error("SDL_CreateTextureFromSurface");
+    }
+    textures.emplace_back(surface, texture);
+  };
+  for (const auto &line : frame.lines)
+  {
+    keep(line.surface.get());
+  }
+  if (frame.has_stopwatch && frame.atlas)
+  {
+    keep(frame.atlas->surface().get());
+  }
+  if (!frame.transitions.empty())
+  {
+    keep(frame.digits->surface().get());
+  }
+  if (frame.distance)
+  {
+    keep(frame.distance->surface().get());
+  }
+  for (const auto &[surface, texture] : screen.textures)
+  {
+    if (texture)
+    {
+      SDL_DestroyTexture(texture);
+    }
+  }
+  screen.textures.swap(textures);
+  screen.frame = frame;
+  if (frame.distance)
+  {
+    draw_distance(screen);
+  }
+}
+
+SDL_Texture *wall_clock::texture(const SCREEN &screen,
+                                 const SDL_Surface *surface)
+{
+  for (const auto &[cached, texture] : screen.textures)
+  {
+    if (cached == surface)
+    {
+      return texture;
+    }
+  }
+  return nullptr;
+}
+
+bool wall_clock::resize(SCREEN &screen)
+{
+  SDL_Point size;
+  SDL_GetWindowSizeInPixels(screen.window, &size.x, &size.y);
+  SDL_DisplayMode mode;
+  if (SDL_GetWindowDisplayMode(screen.window, &mode) == 0 &&
+      mode.refresh_rate > 0)
+  {
+    screen.frame_interval = 1000 / mode.refresh_rate;
+  }
+  if (size.x == screen.window_size.x && size.y == screen.window_size.y)
+  {
+    return false;
+  }
+  screen.window_size = size;
+  if (control_.joinable())
+  {
+    SDL_Event event{};
+    event.type = SDL_WINDOWEVENT;
+    event.window.event = SDL_WINDOWEVENT_RESIZED;
+    event.window.windowID = screen.window_id;
+    event.window.data1 = size.x;
+    event.window.data2 = size.y;
+    queue(event);
+  }
+  else
+  {
+    screen.width = size.x;
+    screen.height = size.y;
+  }
+  return true;
+}
+
+bool wall_clock::set_display(SCREEN &screen, int display, bool fullscreen)
+{
+  auto wnd = screen.window;
+  if (display >= 0 && display != SDL_GetWindowDisplayIndex(wnd))
+  {
+    if ((SDL_GetWindowFlags(wnd) & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP)
+    {
+      SDL_SetWindowFullscreen(wnd, 0);
+    }
+    SDL_Rect current_frame;
+    if (SDL_GetDisplayUsableBounds(SDL_GetWindowDisplayIndex(wnd), &current_frame) != 0)
+    {
+      throw std::runtime_error("SDL_GetDisplayUsableBounds(current)");
+    }
+    SDL_Rect current_window;
+    SDL_GetWindowPosition(wnd, &current_window.x, &current_window.y);
+    SDL_GetWindowSize(wnd, &current_window.w, &current_window.h);
+    SDL_Rect new_frame;
+    if (SDL_GetDisplayUsableBounds(display, &new_frame) != 0)
+    {
+      throw std::runtime_error("SDL_GetWindowDisplayIndex(new)");
+    }
+    SDL_Rect new_window{
+        new_frame.x + (current_window.x - current_frame.x) * new_frame.w / current_frame.w,
+        new_frame.y + (current_window.y - current_frame.y) * new_frame.h / current_frame.h,
+        current_window.w * new_frame.w / current_frame.w,
+        current_window.h * new_frame.h / current_frame.h,
+    };
+    SDL_SetWindowPosition(wnd, new_window.x, new_window.y);
+    SDL_SetWindowSize(wnd, new_window.w, new_window.h);
+  }
+  return set_window(screen, fullscreen);
+}
+
+bool wall_clock::set_window(SCREEN &screen, bool fullscreen)
+{
+  auto wnd = screen.window;
+  if (fullscreen)
+  {
+    if ((SDL_GetWindowFlags(wnd) & SDL_WINDOW_FULLSCREEN_DESKTOP) != SDL_WINDOW_FULLSCREEN_DESKTOP)
+    {
+      if (SDL_SetWindowFullscreen(wnd, SDL_WINDOW_FULLSCREEN_DESKTOP) != 0)
+      {
+        throw std::runtime_error("SDL_SetWindowFullscreen(true)");
+      }
+    }
+  }
+  else
+  {
+    if ((SDL_GetWindowFlags(wnd) & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP)
+    {
+      if (SDL_SetWindowFullscreen(wnd, 0) != 0)
+      {
+        throw std::runtime_error("SDL_SetWindowFullscreen(false)");
+      }
+    }
+  }
+  return resize(screen);
+}
+
+void wall_clock::set_fonts()
+{
+  lines_height_ = calculate_lines_height();
+  for (auto &screen : screens_)
+  {
+    set_fonts(*screen);
+  }
+}
+
+void wall_clock::set_fonts(SCREEN &screen)
+{
+  trace::span span{"set_fonts"};
+  reset_big_font(screen);
+  if (!started_)
+  {
+    return;
+  }
+  auto text_width = std::max(screen.digit_width * 6 + screen.colon_width * 2,
+                             screen.width);
+  auto font_medium = screen.font_medium;
+  screen.font_medium = open_font(screen.width * screen.height * 2 /
+                                     lines_height_ / text_width,
+                                 screen.scale_medium);
+  fonts_.close(font_medium);
+  auto font_small = screen.font_small;
+  screen.font_small = open_font(screen.width * screen.height * 1 /
+                                    lines_height_ / text_width,
+                                screen.scale_small);
+  fonts_.close(font_small);
+  int space_width, a_width, p_width, m_width;
+  if (sdf_ && distance_)
+  {
+    space_width = distance_->width(' ');
+    a_width = distance_->width('A');
+    p_width = distance_->width('P');
+    m_width = distance_->width('M');
+  }
+  else if (TTF_SizeText(screen.font_medium, " ", &space_width, nullptr) < 0 ||
+           TTF_SizeText(screen.font_medium, "A", &a_width, nullptr) < 0 ||
+           TTF_SizeText(screen.font_medium, "P", &p_width, nullptr) < 0 ||
+           TTF_SizeText(screen.font_medium, "M", &m_width, nullptr) < 0)
+  {
+    throw std::runtime_error("TTF_SizeText");
+  }
+  screen.ampm_width = std::lround(
+      (space_width + std::max(a_width, p_width) + m_width) *
+      screen.scale_medium);
+  screen.face.reset();
+  // Screens of the same size get the same font from the cache, and then
+  // share its atlas as well. With distance field text the font, and so the
+  // atlas, stays the same over resizes.
+  if (screen.font_medium != font_medium)
+  {
+    screen.atlas_medium.reset();
+  }
+  for (const auto &other : screens_)
+  {
+    if (other.get() != &screen && other->font_medium == screen.font_medium &&
+        other->atlas_medium)
+    {
+      screen.atlas_medium = other->atlas_medium;
+    }
+  }
+  if (!screen.atlas_medium)
+  {
+    auto atlas = std::make_shared<glyph_atlas>();
+    atlas->build(screen.font_medium, "0123456789:.- L");
+    screen.atlas_medium = atlas;
+  }
+  set_big_font(screen);
+}
+
+void wall_clock::reset_big_font(SCREEN &screen)
+{
+  forget_lines(screen);
+  auto font_big = screen.font_big;
+  screen.font_big =
+      open_font(screen.height * 4 / lines_height_, screen.scale_big);
+  fonts_.close(font_big);
+  measure_big_font(screen);
+}
+
+void wall_clock::set_big_font(SCREEN &screen)
+{
+  auto font_big = screen.font_big;
+  screen.font_big =
+      open_font((screen.width - screen.ampm_width) * screen.height * 4 /
+                    lines_height_ /
+                    (std::max(screen.time_width, screen.width) -
+                     screen.ampm_width),
+                screen.scale_big);
+  fonts_.close(font_big);
+  measure_big_font(screen);
+  plan(screen);
+}
+
+void wall_clock::measure_big_font(SCREEN &screen)
+{
+  screen.atlas_big.reset();
+  int digit_width, colon_width;
+  if (sdf_ && distance_)
+  {
+    digit_width = distance_->width('0');
+    colon_width = distance_->width(':');
+  }
+  else if (TTF_SizeText(screen.font_big, "0", &digit_width, nullptr) < 0 ||
+           TTF_SizeText(screen.font_big, ":", &colon_width, nullptr) < 0)
+  {
+    throw std::runtime_error("TTF_SizeText");
+  }
+  screen.digit_width = std::lround(digit_width * screen.scale_big);
+  screen.colon_width = std::lround(colon_width * screen.scale_big);
+  screen.time_width = calculate_time_width(screen);
+}
+
+TTF_Font *wall_clock::open_font(int size, float &scale)
+{
+  // Above max-glyph-size text is rasterized at that size and scaled up by
+  // the renderer, which keeps big screens from uploading huge surfaces.
+  // Distance field text only needs the metrics of the atlas, so every size
+  // shares the font it has, and resizing opens none.
+  scale = 1.0f;
+  if (sdf_ && distance_)
+  {
+    scale = float(size) / DISTANCE_SIZE;
+    size = DISTANCE_SIZE;
+  }
+  else if (max_glyph_size_ && size > max_glyph_size_)
+  {
+    scale = float(size) / max_glyph_size_;
+    size = max_glyph_size_;
+  }
+  return fonts_.open(size);
+}
+
+void wall_clock::build_distance(bool font_changed)
+{
+  // One distance atlas per face serves every size. Its font is opened here,
+  // as SDL_ttf only renders concurrently with fonts of their own.
+  if (font_changed)
+  {
+    if (distance_job_.valid())
+    {
+      distance_job_.wait();
+      distance_job_ = {};
+    }
+    distance_font_.reset();
+    distance_.reset();
+  }
+  if (!distance_blending_)
+  {
+    // Without the blend modes the text stays rasterized.
+    sdf_ = false;
+  }
+  if (sdf_ && !distance_ && !distance_job_.valid())
+  {
+    distance_font_ =
+        fonts_.open_private(DISTANCE_SIZE * DISTANCE_OVERSAMPLE);
+    distance_job_ = std::async(
+        std::launch::async,
+        [font = distance_font_.get()]()
+        {
+          auto atlas = std::make_shared<glyph_atlas>();
+          atlas->build_distance(font);
+          return std::shared_ptr<const glyph_atlas>{atlas};
+        });
+  }
+}
+
+void wall_clock::take_distance()
+{
+  if (distance_job_.valid() &&
+      distance_job_.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready)
+  {
+    distance_ = distance_job_.get();
+    distance_font_.reset();
+    if (sdf_)
+    {
+      set_fonts();
+      redraw(false);
+    }
+  }
+}
+
+void wall_clock::create_audio()
+{
+  SDL_AudioSpec &Alarm = audio_spec_;
+  SDL_AudioSpec obtained;
+  SDL_zero(Alarm);
+  Alarm.freq = audio_rate_;
+  Alarm.format = AUDIO_F32SYS;
+  Alarm.channels = 1;
+  Alarm.samples = audio_buffer_;
+  Alarm.callback = play_audio;
+  Alarm.userdata = this;
+  trace::reserve();
+  audio_device_ = SDL_OpenAudioDevice(
+      nullptr, 0, &Alarm, &obtained,
+      SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+  if (!audio_device_)
+  {
+    throw std::runtime_error("SDL_create_audio");
+  }
+  if (obtained.freq != sample_rate_)
+  {
+    for (auto &timer : timers_)
+    {
+      timer.origin = timer.origin * obtained.freq / sample_rate_;
+    }
+    for (auto &strike : strikes_)
+    {
+      strike.start = strike.start * obtained.freq / sample_rate_;
+    }
+    audio_clock_ = audio_clock_ * obtained.freq / sample_rate_;
+    sample_rate_ = obtained.freq;
+  }
+  if (sample_rate_ != chime_rate_)
+  {
+    for (auto sequence : {&chime_sequence_, &alarm_sequence_})
+    {
+      strikes_.remove_if([&](const auto &strike)
+                         { return strike.voice == sequence->voice.get(); });
+      release_sequence(*sequence);
+    }
+    // Always from the synthesized waves, so that changing the rate back and
+    // forth does not pile up interpolation error.
+    for (std::size_t i = 0; i < chimes_.size(); ++i)
+    {
+      chimes_[i] = bank_[i];
+      if (sample_rate_ != SEGMENT_COUNT * SAMPLE_COUNT)
+      {
+        chimes_[i].resample(SEGMENT_COUNT * SAMPLE_COUNT, sample_rate_);
+      }
+    }
+    chime_rate_ = sample_rate_;
+  }
+  buffer_size_ = obtained.samples;
+  audio_time_ = std::chrono::steady_clock::now();
+  audio_idle_ = true;
+  audio_stats_ = {};
+  if (!strikes_.empty())
+  {
+    SDL_PauseAudioDevice(audio_device_, 0);
+  }
+}
+
+void wall_clock::close_audio()
+{
+  if (audio_device_)
+  {
+    SDL_CloseAudioDevice(audio_device_);
+    audio_device_ = 0;
+  }
+}
+
+void wall_clock::report_audio(std::ostream &os)
+{
+  SDL_LockAudioDevice(audio_device_);
+  auto stats = audio_stats_;
+  SDL_UnlockAudioDevice(audio_device_);
+  if (stats.callbacks != 0)
+  {
+    using milliseconds = std::chrono::duration<float, std::milli>;
+    os << "AUDIO " << sample_rate_ << "HZ " << buffer_size_ << " SAMPLES"
+       << " CALLBACK " << std::fixed << std::setprecision(2)
+       << milliseconds(stats.busy / stats.callbacks).count() << "MS"
+       << " MAX " << milliseconds(stats.longest).count() << "MS"
+       << " HEADROOM " << milliseconds(stats.headroom).count() << "MS"
+       << " UNDERRUNS " << stats.underruns;
+  }
+  else
+  {
+    os << "AUDIO " << sample_rate_ << "HZ " << buffer_size_ << " SAMPLES IDLE";
+  }
+}
+
+void wall_clock::set_config_handlers()
+{
+  config_handlers_ = {
+      {"alarm",
        [&](std::istream &is)
        {
-         std::string fullscreen;
-         if (is >> fullscreen)
+         for (const auto alarm : parse_alarm(is))
          {
-           if (fullscreen == "true")
-           {
-             fullscreen_ = true;
-           }
-           else if (fullscreen == "false")
-           {
-             fullscreen_ = false;
-           }
+           scheduler_.add(alarm);
          }
        }},
-      {"dim",
+      {"volume",
        [&](std::istream &is)
        {
-         std::string dim;
-         if (is >> dim)
+         int volume;
+         if (is >> volume && volume >= 0 && volume <= 100)
          {
-           if (dim == "true")
-           {
-             dim_ = true;
-           }
-           else if (dim == "false")
-           {
-             dim_ = false;
-           }
+           volume_ = volume;
          }
        }},
-      {"whisper",
+      {"display",
        [&](std::istream &is)
        {
-         std::string whisper;
-         if (is >> whisper)
+         int display;
+         if (is >> display && display >= 0 &&
+             display <= SDL_GetNumVideoDisplays())
          {
-           if (whisper == "true")
-           {
-             whisper_ = true;
-           }
-           else if (whisper == "false")
-           {
-             whisper_ = false;
-           }
+           display_ = display - 1;
          }
        }},
-      {"chimes",
+      {"color",
        [&](std::istream &is)
        {
-         std::string chimes;
+         int r, g, b;
+         if (is >> r >> g >> b)
+         {
+           text_color_.r = r;
+           text_color_.g = g;
+           text_color_.b = b;
+         }
+       }},
+      {"background",
+       [&](std::istream &is)
+       {
+         int r, g, b;
+         if (is >> r >> g >> b)
+         {
+           background_.r = r;
+           background_.g = g;
+           background_.b = b;
+         }
+       }},
+      {"hide-cursor",
+       [&](std::istream &is)
+       {
+         std::string hide_cursor;
+         if (is >> hide_cursor)
+         {
+           if (hide_cursor == "true")
+           {
+             hide_cursor_ = true;
+           }
+           else if (hide_cursor == "false")
+           {
+             hide_cursor_ = false;
+           }
+         }
+       }},
+      {"fullscreen",
+       [&](std::istream &is)
+       {
+         std::string fullscreen;
+         if (is >> fullscreen)
+         {
+           if (fullscreen == "true")
+           {
+             fullscreen_ = true;
+           }
+           else if (fullscreen == "false")
+           {
+             fullscreen_ = false;
+           }
+         }
+       }},
+      {"dim",
+       [&](std::istream &is)
+       {
+         std::string dim;
+         if (is >> dim)
+         {
+           if (dim == "true")
+           {
+             dim_ = true;
+           }
+           else if (dim == "false")
+           {
+             dim_ = false;
+           }
+         }
+       }},
+      {"face",
+       [&](std::istream &is)
+       {
+         std::string face;
+         if (is >> face)
+         {
+           if (face == "analog")
+           {
+             analog_ = true;
+           }
+           else if (face == "digital")
+           {
+             analog_ = false;
+           }
+         }
+       }},
+      {"sweep",
+       [&](std::istream &is)
+       {
+         std::string sweep;
+         if (is >> sweep)
+         {
+           if (sweep == "true")
+           {
+             sweep_ = true;
+           }
+           else if (sweep == "false")
+           {
+             sweep_ = false;
+           }
+         }
+       }},
+      {"sdf",
+       [&](std::istream &is)
+       {
+         std::string sdf;
+         if (is >> sdf)
+         {
+           if (sdf == "true")
+           {
+             sdf_ = true;
+           }
+           else if (sdf == "false")
+           {
+             sdf_ = false;
+           }
+         }
+       }},
+      {"max-glyph-size",
+       [&](std::istream &is)
+       {
+         int max_glyph_size;
+         if (is >> max_glyph_size &&
+             (max_glyph_size == 0 || max_glyph_size >= 8))
+         {
+           max_glyph_size_ = max_glyph_size;
+         }
+       }},
+      {"pixel-shift",
+       [&](std::istream &is)
+       {
+         int pixel_shift;
+         if (is >> pixel_shift && pixel_shift >= 0 && pixel_shift <= 16)
+         {
+           pixel_shift_ = pixel_shift;
+         }
+       }},
+      {"transition",
+       [&](std::istream &is)
+       {
+         std::string transition;
+         if (is >> transition)
+         {
+           if (transition == "none")
+           {
+             transition_ = TRANSITION_NONE;
+           }
+           else if (transition == "slide")
+           {
+             transition_ = TRANSITION_SLIDE;
+           }
+           else if (transition == "flip")
+           {
+             transition_ = TRANSITION_FLIP;
+           }
+         }
+       }},
+      {"whisper",
+       [&](std::istream &is)
+       {
+         std::string whisper;
+         if (is >> whisper)
+         {
+           if (whisper == "true")
+           {
+             whisper_ = true;
+           }
+           else if (whisper == "false")
+           {
+             whisper_ = false;
+           }
+         }
+       }},
+      {"chimes",
+       [&](std::istream &is)
+       {
+         std::string chimes;
          if (is >> chimes)
          {
            if (chimes == "true")
@@ -514,6 +1452,41 @@ void wall_clock::set_config_handlers()
            }
          }
        }},
+      {"layout",
+       [&](std::istream &is)
+       {
+         const std::map<std::string, int> kinds = {{"time", ROW_TIME},
+                                                   {"weekday", ROW_WEEKDAY},
+                                                   {"date", ROW_DATE},
+                                                   {"options", ROW_OPTIONS}};
+         const std::map<std::string, int> aligns = {{"left", ALIGN_LEFT},
+                                                    {"center", ALIGN_CENTER},
+                                                    {"right", ALIGN_RIGHT}};
+         std::vector<ROW> layout;
+         bool has_time = false;
+         std::string row;
+         while (is >> row)
+         {
+           auto colon = row.find(':');
+           auto kind = kinds.find(row.substr(0, colon));
+           auto align = aligns.find(
+               colon != std::string::npos ? row.substr(colon + 1) : "center");
+           // Unknown and repeated lines are skipped; the rest still apply.
+           if (kind == kinds.end() || align == aligns.end() ||
+               std::any_of(layout.begin(), layout.end(),
+                           [&](const ROW &other)
+                           { return other.kind == kind->second; }))
+           {
+             continue;
+           }
+           has_time = has_time || kind->second == ROW_TIME;
+           layout.push_back({kind->second, align->second, 0, 0});
+         }
+         if (has_time)
+         {
+           layout_ = layout;
+         }
+       }},
       {"24-hour",
        [&](std::istream &is)
        {
@@ -654,529 +1627,2168 @@ void wall_clock::set_config_handlers()
            }
          }
        }},
+      {"audio-rate",
+       [&](std::istream &is)
+       {
+         int audio_rate;
+         if (is >> audio_rate && audio_rate >= 8000 && audio_rate <= 192000)
+         {
+           audio_rate_ = audio_rate;
+         }
+       }},
+      {"audio-buffer",
+       [&](std::istream &is)
+       {
+         int audio_buffer;
+         if (is >> audio_buffer && audio_buffer >= 16 && audio_buffer <= 16384)
+         {
+           audio_buffer_ = audio_buffer;
+         }
+       }},
+      {"missed-alarm",
+       [&](std::istream &is)
+       {
+         std::string missed_alarm;
+         if (is >> missed_alarm)
+         {
+           if (missed_alarm == "fire")
+           {
+             fire_missed_alarms_ = true;
+           }
+           else if (missed_alarm == "skip")
+           {
+             fire_missed_alarms_ = false;
+           }
+         }
+       }},
+      {"font",
+       [&](std::istream &is)
+       {
+         std::string font;
+         if (std::getline(is >> std::ws, font))
+         {
+           font_path_ = font;
+         }
+       }},
   };
 }
 
-int wall_clock::calculate_time_width()
+std::vector<std::size_t> wall_clock::parse_alarm(std::istream &is)
+{
+  std::vector<std::size_t> alarms;
+  char colon;
+  int hour, minute;
+  if (is >> hour >> colon >> minute)
+  {
+    if (colon == ':' && hour < 24 && hour >= 0 && minute < 60 &&
+        minute >= 0)
+    {
+      std::vector<std::size_t> alarm_weekdays;
+      std::string weekday;
+      bool inactive = false;
+      while (is >> weekday)
+      {
+        std::transform<std::string::iterator, std::string::iterator,
+                       int (*)(int)>(weekday.begin(), weekday.end(),
+                                     weekday.begin(), std::toupper);
+        if (weekday == "WEEKDAYS")
+        {
+          for (const auto wd : {1, 2, 3, 4, 5})
+          {
+            alarm_weekdays.push_back(wd);
+          }
+        }
+        else if (weekday == "WEEKEND")
+        {
+          for (const auto wd : {0, 6})
+          {
+            alarm_weekdays.push_back(wd);
+          }
+        }
+        else if (weekday == "NEVER")
+        {
+          alarm_weekdays.clear();
+          inactive = true;
+          break;
+        }
+        else
+        {
+          auto day =
+              std::find(weekdays_full_.begin(), weekdays_full_.end(), weekday);
+          if (day != weekdays_full_.end())
+          {
+            alarm_weekdays.push_back(day - weekdays_full_.begin());
+          }
+        }
+      }
+      if (alarm_weekdays.empty() && !inactive)
+      {
+        for (auto it = weekdays_full_.begin(); it != weekdays_full_.end(); ++it)
+        {
+          alarm_weekdays.push_back(it - weekdays_full_.begin());
+        }
+      }
+      for (const auto &alarm_weekday : alarm_weekdays)
+      {
+        alarms.push_back((alarm_weekday * 24 + hour) * 60 + minute);
+      }
+    }
+  }
+  return alarms;
+}
+
+int wall_clock::calculate_time_width(const SCREEN &screen)
 {
-  return digit_width_ * 4 + colon_width_ +
-         (seconds_ ? digit_width_ * 2 + colon_width_ : 0) +
-         (time_24_ ? 0 : ampm_width_);
+  return screen.digit_width * 4 + screen.colon_width +
+         (seconds_ ? screen.digit_width * 2 + screen.colon_width : 0) +
+         (time_24_ ? 0 : screen.ampm_width);
 }
 
 int wall_clock::calculate_lines_height()
 {
-  return (has_sound_info_ ? 1 : 0) +
-         (date_ != "?" ? 2 : 0) +
-         (weekday_ != "?" ? 2 : 0) +
-         4;
+  // The time always takes four parts of the height.
+  int height = 4;
+  for (const auto &row : rows_)
+  {
+    if (row.kind != ROW_TIME)
+    {
+      height += row.kind == ROW_OPTIONS ? 1 : 2;
+    }
+  }
+  return height;
+}
+
+void wall_clock::plan_rows()
+{
+  rows_.clear();
+  for (auto row : layout_)
+  {
+    if ((row.kind == ROW_WEEKDAY && weekday_ == "?") ||
+        (row.kind == ROW_DATE && !has_date_line()) ||
+        (row.kind == ROW_OPTIONS && !has_sound_info_))
+    {
+      continue;
+    }
+    // A running stopwatch takes the place of the date.
+    if (row.kind == ROW_DATE && has_stopwatch())
+    {
+      row.kind = ROW_STOPWATCH;
+    }
+    rows_.push_back(row);
+  }
+  // Without a date row the stopwatch still shows, below the others.
+  if (has_stopwatch() &&
+      std::none_of(layout_.begin(), layout_.end(),
+                   [](const ROW &row) { return row.kind == ROW_DATE; }))
+  {
+    rows_.push_back({ROW_STOPWATCH, ALIGN_CENTER, 0, 0});
+  }
+}
+
+void wall_clock::plan(SCREEN &screen)
+{
+  // Which rows there are and how high they are only changes with the
+  // configuration, the stopwatch and the fonts, so where they go is worked
+  // out here and every redraw just follows the plan.
+  if (!started_)
+  {
+    return;
+  }
+  auto height = [&](int kind)
+  {
+    switch (kind)
+    {
+    case ROW_TIME:
+      return int(std::lround(TTF_FontHeight(screen.font_big) *
+                             screen.scale_big));
+    case ROW_STOPWATCH:
+      return int(screen.atlas_medium->measure("").y * screen.scale_medium);
+    case ROW_OPTIONS:
+      return int(std::lround(TTF_FontHeight(screen.font_small) *
+                             screen.scale_small));
+    default:
+      return int(std::lround(TTF_FontHeight(screen.font_medium) *
+                             screen.scale_medium));
+    }
+  };
+  int total_height = 0;
+  for (const auto &row : rows_)
+  {
+    total_height += height(row.kind);
+  }
+  int space = (screen.height - total_height) / int(rows_.size() + 1);
+  int margin = screen.width / LAYOUT_MARGIN;
+  int y = space;
+  std::vector<ROW> plan;
+  for (auto row : rows_)
+  {
+    row.x = row.align == ALIGN_LEFT    ? margin
+            : row.align == ALIGN_RIGHT ? screen.width - margin
+                                       : screen.width / 2;
+    row.y = y;
+    y += height(row.kind) + space;
+    plan.push_back(row);
+  }
+  screen.plan = plan;
+}
+
+float wall_clock::get_volume()
+{
+  return (volume_ / 100.0f) * (whisper_ ? tense_ : 1.0f) * 0.5f;
+}
+
+int wall_clock::chime_count(int hour)
+{
+  return hour % 12 != 0 ? hour % 12 : 12;
+}
+
+const char *wall_clock::ampm(int hour) { return hour < 12 ? " AM" : " PM"; }
+
+void wall_clock::run()
+{
+  if (clock_.simulated())
+  {
+    simulate();
+    return;
+  }
+  trace::name_thread("render");
+  first_frame();
+  stage("first frame");
+  control_ = std::thread(&wall_clock::control, this);
+  while (running_)
+  {
+    int timeout = 1000;
+    for (const auto &screen : screens_)
+    {
+      if (!screen->hidden &&
+          animated(*screen, std::chrono::steady_clock::now()))
+      {
+        auto since = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - screen->present_time)
+                         .count();
+        timeout = std::max(
+            0, std::min<int>(timeout, screen->frame_interval - since));
+      }
+    }
+    SDL_Event event;
+    if (SDL_WaitEventTimeout(&event, timeout) == 1 &&
+        event.type != frame_event_)
+    {
+      forward(event);
+    }
+    // A new frame covers every screen, so all of them present it together;
+    // hidden ones present nothing until they are shown again.
+    auto adopted = adopt();
+    for (auto &screen : screens_)
+    {
+      if (screen->hidden)
+      {
+        continue;
+      }
+      if (adopted ||
+          (animated(*screen, std::chrono::steady_clock::now()) &&
+           std::chrono::steady_clock::now() - screen->present_time >=
+               std::chrono::milliseconds(screen->frame_interval)))
+      {
+        compose(*screen);
+      }
+    }
+  }
+  control_.join();
+  if (error_)
+  {
+    std::rethrow_exception(error_);
+  }
+}
+
+int wall_clock::handle_event(SDL_Event *event)
+{
+  int iResult = 0;
+  if (event->type == command_event_)
+  {
+    std::unique_ptr<control_socket::COMMAND> command{
+        static_cast<control_socket::COMMAND *>(event->user.data1)};
+    control_socket::reply(*command, execute(*command));
+    return iResult;
+  }
+  switch (event->type)
+  {
+  case SDL_QUIT:
+    iResult = -1;
+    break;
+  case SDL_KEYUP:
+    switch (event->key.keysym.scancode)
+    {
+    case SDL_SCANCODE_F1:
+      if (SDL_OpenURL(help_path_.c_str()) != 0)
+      {
+        throw std::runtime_error("SDL_OpenURL(help)");
+      }
+      break;
+    case SDL_SCANCODE_ESCAPE:
+      iResult = -1;
+      break;
+    case SDL_SCANCODE_SPACE:
+      silent();
+      break;
+    case SDL_SCANCODE_R:
+      test_bell();
+      break;
+    case SDL_SCANCODE_RETURN:
+      read_config();
+      redraw(false);
+      break;
+    case SDL_SCANCODE_0:
+      start_timer(0);
+      break;
+    case SDL_SCANCODE_1:
+      start_timer(1);
+      break;
+    case SDL_SCANCODE_2:
+      start_timer(2);
+      break;
+    case SDL_SCANCODE_3:
+      start_timer(3);
+      break;
+    case SDL_SCANCODE_4:
+      start_timer(4);
+      break;
+    case SDL_SCANCODE_5:
+      start_timer(5);
+      break;
+    case SDL_SCANCODE_6:
+      start_timer(6);
+      break;
+    case SDL_SCANCODE_7:
+      start_timer(7);
+      break;
+    case SDL_SCANCODE_8:
+      start_timer(8);
+      break;
+    case SDL_SCANCODE_9:
+      start_timer(9);
+      break;
+    case SDL_SCANCODE_MINUS:
+      stop_timer();
+      break;
+    case SDL_SCANCODE_D:
+      debug_ = !debug_;
+      redraw(false);
+      break;
+    case SDL_SCANCODE_T:
+      new_timer();
+      break;
+    case SDL_SCANCODE_S:
+      toggle_stopwatch();
+      break;
+    case SDL_SCANCODE_L:
+      lap_stopwatch();
+      break;
+    case SDL_SCANCODE_BACKSPACE:
+      reset_stopwatch();
+      break;
+    }
+    break;
+  case SDL_MOUSEBUTTONUP:
+    iResult = -1;
+    break;
+  case SDL_FINGERUP:
+    iResult = -1;
+    break;
+  case SDL_WINDOWEVENT:
+    switch (event->window.event)
+    {
+    case SDL_WINDOWEVENT_CLOSE:
+      // With several windows SDL only sends SDL_QUIT after the last one is
+      // closed; closing any of them exits, as a click in it does.
+      iResult = -1;
+      break;
+    case SDL_WINDOWEVENT_RESIZED:
+    {
+      auto screen = find_screen(event->window.windowID);
+      if (screen)
+      {
+        screen->width = event->window.data1;
+        screen->height = event->window.data2;
+        set_fonts(*screen);
+        redraw(false);
+      }
+      break;
+    }
+    case SDL_WINDOWEVENT_HIDDEN:
+    {
+      auto screen = find_screen(event->window.windowID);
+      if (screen && !screen->suspended)
+      {
+        screen->suspended = true;
+        if (suspended())
+        {
+          suspended_since_ = std::chrono::steady_clock::now();
+        }
+      }
+      break;
+    }
+    case SDL_WINDOWEVENT_SHOWN:
+    {
+      // Nothing was drawn for the window while it was hidden.
+      auto screen = find_screen(event->window.windowID);
+      if (screen && screen->suspended)
+      {
+        if (suspended())
+        {
+          metrics_.suspended.observe(std::chrono::steady_clock::now() -
+                                     suspended_since_);
+        }
+        screen->suspended = false;
+        redraw(false);
+      }
+      break;
+    }
+    }
+    break;
+  }
+  return iResult;
+}
+
+std::string wall_clock::execute(const control_socket::COMMAND &command)
+{
+  std::istringstream is{command.line};
+  std::string verb, action;
+  is >> verb;
+  if (verb == "timer" && is >> action)
+  {
+    int delay = 0;
+    std::string name;
+    if (action == "start" && (is >> std::ws).eof())
+    {
+      start_timer(0);
+    }
+    else if (action == "start" && is >> delay && delay >= 0)
+    {
+      if (is >> name)
+      {
+        start_timer(name, delay);
+      }
+      else
+      {
+        start_timer(delay);
+      }
+    }
+    else if (action == "stop")
+    {
+      if (is >> name)
+      {
+        stop_timer(name);
+      }
+      else
+      {
+        stop_timer();
+      }
+    }
+    else
+    {
+      return "ERR usage: timer start [DELAY [NAME]] | timer stop [NAME]";
+    }
+  }
+  else if (verb == "alarm" && is >> action &&
+           (action == "add" || action == "remove"))
+  {
+    auto alarms = parse_alarm(is);
+    if (alarms.empty())
+    {
+      return "ERR usage: alarm add|remove HH:MM [DAYS]";
+    }
+    for (const auto alarm : alarms)
+    {
+      if (action == "add")
+      {
+        removed_alarms_.erase(alarm);
+        added_alarms_.insert(alarm);
+        scheduler_.add(alarm);
+      }
+      else
+      {
+        added_alarms_.erase(alarm);
+        removed_alarms_.insert(alarm);
+        scheduler_.remove(alarm);
+      }
+    }
+    next_alarm_ = scheduler_.next(alarm_scheduler::minute(now_));
+    update_alarm_lead();
+  }
+  else if (verb == "bell")
+  {
+    test_bell();
+  }
+  else if (verb == "silent")
+  {
+    silent();
+  }
+  else if (verb == "state")
+  {
+    return state();
+  }
+  else
+  {
+    return "ERR unknown command";
+  }
+  command_received_ = command.received;
+  redraw(false);
+  command_latency_ = std::chrono::steady_clock::now() - command.received;
+  return "OK";
+}
+
+std::string wall_clock::state()
+{
+  std::ostringstream os;
+  os << std::setfill('0') << "OK time=" << std::setw(2) << now_.tm_hour << ':'
+     << std::setw(2) << now_.tm_min << ':' << std::setw(2) << now_.tm_sec
+     << " chimes=" << (has_chimes_ ? "on" : "off")
+     << " alarms=" << (has_alarms_ ? "on" : "off") << " next-alarm=";
+  if (next_alarm_ != std::size_t(-1))
+  {
+    os << weekdays_abbreviated_[next_alarm_ / (60 * 24)] << '-' << std::setw(2)
+       << next_alarm_ / 60 % 24 << ':' << std::setw(2) << next_alarm_ % 60;
+  }
+  else
+  {
+    os << "none";
+  }
+  os << " timers=";
+  for (std::size_t i = 0; i < timers_.size(); ++i)
+  {
+    int seconds = (frame_time_ - timers_[i].base) / std::chrono::seconds(1);
+    os << (i ? "," : "") << timers_[i].name << ':' << (seconds < 0 ? "-" : "")
+       << std::abs(seconds);
+  }
+  if (timers_.empty())
+  {
+    os << "none";
+  }
+  SDL_LockAudioDevice(audio_device_);
+  auto ring = ringing();
+  SDL_UnlockAudioDevice(audio_device_);
+  os << " ringing=" << (ring ? "yes" : "no") << " handled-us="
+     << std::chrono::duration_cast<std::chrono::microseconds>(command_latency_)
+            .count()
+     << " present-us=" << present_latency_.load()
+     << " suspended=" << (suspended() ? "yes" : "no");
+  return os.str();
+}
+
+void wall_clock::read_config()
+{
+  trace::span span{"read_config"};
+  auto begin = std::chrono::steady_clock::now();
+  auto volume = get_volume();
+  auto timer_interval = timer_interval_;
+  volume_ = 100;
+  display_ = -1;
+  text_color_ = {255, 255, 255, 255};
+  background_ = {0, 0, 0, 255};
+  hide_cursor_ = true;
+  fullscreen_ = true;
+  dim_ = true;
+  transition_ = TRANSITION_NONE;
+  analog_ = false;
+  sweep_ = false;
+  pixel_shift_ = 0;
+  auto sdf = sdf_ && distance_;
+  sdf_ = false;
+  auto max_glyph_size = max_glyph_size_;
+  max_glyph_size_ = 0;
+  whisper_ = true;
+  has_chimes_ = false;
+  has_alarms_ = false;
+  has_sound_info_ = true;
+  weekday_ = "%A";
+  date_ = "%m/%d/%Y";
+  layout_ = {{ROW_TIME, ALIGN_CENTER, 0, 0},
+             {ROW_WEEKDAY, ALIGN_CENTER, 0, 0},
+             {ROW_DATE, ALIGN_CENTER, 0, 0},
+             {ROW_OPTIONS, ALIGN_CENTER, 0, 0}};
+  time_24_ = true;
+  seconds_ = true;
+  pad_hour_ = true;
+  pad_minute_ = true;
+  pad_second_ = true;
+  pad_year_ = true;
+  pad_month_ = true;
+  pad_day_ = true;
+  timer_interval_ = 10;
+  fire_missed_alarms_ = true;
+  audio_rate_ = SEGMENT_COUNT * SAMPLE_COUNT;
+  audio_buffer_ = SAMPLE_COUNT;
+  font_path_.clear();
+  scheduler_.clear();
+  next_alarm_ = std::size_t(-1);
+  const char *home_directory = getenv(HOME);
+  if (home_directory)
+  {
+    std::string conf_path{home_directory};
+    conf_path += "/.clock.conf";
+    std::ifstream config_file(conf_path.c_str());
+    std::string config;
+    while (std::getline(config_file, config))
+    {
+      std::istringstream pair_stream{config};
+      std::string key;
+      pair_stream >> key;
+      auto handler = config_handlers_.find(key);
+      if (handler != config_handlers_.end())
+      {
+        handler->second(pair_stream);
+      }
+    }
+  }
+  weekday_format_ = compile_format(weekday_);
+  date_format_ = compile_format(date_);
+  plan_rows();
+  for (const auto alarm : added_alarms_)
+  {
+    scheduler_.add(alarm);
+  }
+  for (const auto alarm : removed_alarms_)
+  {
+    scheduler_.remove(alarm);
+  }
+  next_alarm_ = scheduler_.next(alarm_scheduler::minute(now_));
+  update_alarm_lead();
+  metrics_.config_reloads.add();
+  metrics_.config_parse.observe(std::chrono::steady_clock::now() - begin);
+  auto font_changed = fonts_.select(font_path_);
+  if (audio_device_ &&
+      (audio_rate_ != audio_spec_.freq || audio_buffer_ != audio_spec_.samples))
+  {
+    close_audio();
+    create_audio();
+  }
+  if (get_volume() != volume || timer_interval_ != timer_interval)
+  {
+    for (auto &timer : timers_)
+    {
+      requeue_timer_bells(timer);
+    }
+  }
+  build_distance(font_changed);
+  if (font_changed || max_glyph_size != max_glyph_size_ ||
+      sdf != (sdf_ && distance_) || lines_height_ != calculate_lines_height())
+  {
+    set_fonts();
+  }
+  else
+  {
+    for (auto &screen : screens_)
+    {
+      if (screen->time_width != calculate_time_width(*screen))
+      {
+        reset_big_font(*screen);
+        set_big_font(*screen);
+      }
+      else
+      {
+        plan(*screen);
+      }
+    }
+  }
+}
+
+void wall_clock::tick()
+{
+  trace::span span{"tick"};
+  detect_jump();
+  take_distance();
+  static std::time_t tPre = std::chrono::system_clock::to_time_t(
+      frame_time_ - std::chrono::minutes(1));
+  std::time_t t = std::chrono::system_clock::to_time_t(frame_time_);
+  if (tPre != t)
+  {
+    now_ = *std::localtime(&t);
+    auto pre = *std::localtime(&tPre);
+    if (pre.tm_min != now_.tm_min)
+    {
+      update_tense();
+      check_alarms();
+      redraw(false);
+      // Read the configuration once the minute is on screen, so file I/O
+      // never delays its first frame. The second redraw shows the changes at
+      // once; only an alarm added for this very minute is skipped, as the
+      // minute has already been checked.
+      read_config();
+      redraw(false);
+    }
+    else if (!timers_.empty())
+    {
+      for (auto &timer : timers_)
+      {
+        queue_timer_bells(timer);
+      }
+      redraw(false);
+    }
+    else if (seconds_)
+    {
+      redraw(true);
+    }
+    tPre = t;
+    prepare(t + 1);
+  }
+}
+
+void wall_clock::update_tense()
+{
+  tense_ = tense(now_);
+  pitch_ = 12 - std::abs(now_.tm_hour - 12);
+}
+
+float wall_clock::tense(const std::tm &time)
+{
+  return std::max(0, 8 * 60 - std::abs(time.tm_hour * 60 + time.tm_min -
+                                       14 * 60)) /
+             static_cast<float>(8 * 60) * 0.85f +
+         0.15f;
+}
+
+std::string wall_clock::format_time(const std::tm &time)
+{
+  std::stringstream sTime;
+  sTime << std::setfill('0') << std::setw(pad_hour_ ? 2 : 0)
+        << (time_24_ ? time.tm_hour : chime_count(time.tm_hour)) << ":"
+        << std::setw(pad_minute_ ? 2 : 0) << time.tm_min;
+  return sTime.str();
+}
+
+std::string wall_clock::format_second(const std::tm &time)
+{
+  std::stringstream sSecond;
+  sSecond << ":" << std::setfill('0') << std::setw(pad_second_ ? 2 : 0)
+          << time.tm_sec;
+  return sSecond.str();
+}
+
+std::vector<wall_clock::FIELD>
+wall_clock::compile_format(const std::string &format)
+{
+  std::vector<FIELD> fields;
+  bool ctrl = false;
+  for (const auto &c : format)
+  {
+    if (ctrl)
+    {
+      fields.push_back({c, {}});
+      ctrl = false;
+    }
+    else if (c == '%')
+    {
+      ctrl = true;
+    }
+    else if (!fields.empty() && fields.back().code == 0)
+    {
+      fields.back().text += c;
+    }
+    else
+    {
+      fields.push_back({0, std::string(1, c)});
+    }
+  }
+  return fields;
+}
+
+std::string wall_clock::format_weekday(const std::tm &time)
+{
+  std::stringstream sWeekday;
+  if (!timers_.empty())
+  {
+    for (const auto &timer : timers_)
+    {
+      int seconds = (frame_time_ - timer.base) / std::chrono::seconds(1);
+      if (timers_.size() > 1)
+      {
+        sWeekday << timer.name;
+      }
+      sWeekday << std::setfill('0') << (seconds < 0 ? "-" : " ")
+               << std::setw(pad_minute_ ? 2 : 0) << std::abs(seconds) / 60 << ":"
+               << std::setw(pad_second_ ? 2 : 0) << std::abs(seconds) % 60 << " ";
+    }
+    return sWeekday.str();
+  }
+  for (const auto &field : weekday_format_)
+  {
+    switch (field.code)
+    {
+    case 0:
+      sWeekday << field.text;
+      break;
+    case 'A':
+      sWeekday << weekdays_full_[time.tm_wday];
+      break;
+    case 'a':
+      sWeekday << weekdays_abbreviated_[time.tm_wday];
+      break;
+    case 'w':
+      sWeekday << time.tm_wday;
+      break;
+    case 'u':
+      sWeekday << (time.tm_wday > 0 ? time.tm_wday : 7);
+      break;
+    }
+  }
+  return sWeekday.str();
+}
+
+std::string wall_clock::format_date(const std::tm &time)
+{
+  std::stringstream sDate;
+  sDate << std::setfill('0');
+  for (const auto &field : date_format_)
+  {
+    switch (field.code)
+    {
+    case 0:
+      sDate << field.text;
+      break;
+    case 'm':
+      sDate << std::setw(pad_month_ ? 2 : 0) << time.tm_mon + 1;
+      break;
+    case 'b':
+      sDate << months_[time.tm_mon];
+      break;
+    case 'd':
+      sDate << std::setw(pad_day_ ? 2 : 0) << time.tm_mday;
+      break;
+    case 'Y':
+      sDate << time.tm_year + 1900;
+      break;
+    case 'y':
+      sDate << std::setw(pad_year_ ? 2 : 0) << time.tm_year % 100;
+      break;
+    }
+  }
+  return sDate.str();
+}
+
+std::string wall_clock::format_options()
+{
+  std::stringstream sInfo;
+  sInfo << "\x5:" << (has_chimes_ ? '\x7' : '\x8') << "  "
+        << "\x6:" << (has_alarms_ ? '\x7' : '\x8') << " ";
+  if (next_alarm_ != std::size_t(-1))
+  {
+    auto day = next_alarm_ / (60 * 24);
+    auto hour = next_alarm_ / 60 % 24;
+    auto minute = next_alarm_ % 60;
+    sInfo << weekdays_abbreviated_[day]
+          << " " << std::setfill('0') << std::setw(pad_hour_ ? 2 : 0)
+          << (time_24_ ? hour : chime_count(hour)) << ':'
+          << std::setw(pad_minute_ ? 2 : 0) << minute
+          << (time_24_ ? "" : ampm(hour));
+  }
+  return sInfo.str();
+}
+
+void wall_clock::prepare(std::time_t next)
+{
+  // Rasterize the text of the coming second now, so the frame at the
+  // boundary only has to pick it up.
+  prepared_.clear();
+  auto time = *std::localtime(&next);
+  auto add = [&](const std::string &text, TTF_Font *font)
+  {
+    if (std::none_of(prepared_.begin(), prepared_.end(),
+                     [&](const LINE &line)
+                     { return line.font == font && line.text == text; }))
+    {
+      prepared_.emplace_back();
+      rasterize(prepared_.back(), text, font);
+    }
+  };
+  for (const auto &screen : screens_)
+  {
+    if (screen->suspended || analog_ || (sdf_ && distance_))
+    {
+      continue;
+    }
+    if (seconds_)
+    {
+      add(format_second(time), screen->font_big);
+    }
+    if (time.tm_min != now_.tm_min)
+    {
+      add(format_time(time), screen->font_big);
+    }
+  }
+}
+
+void wall_clock::detect_jump()
+{
+  if (steady_reference_.time_since_epoch().count() != 0)
+  {
+    auto drift = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (frame_time_ - wall_reference_) - (steady_time_ - steady_reference_));
+    if (std::abs(drift.count()) > JUMP_THRESHOLD)
+    {
+      for (auto &timer : timers_)
+      {
+        timer.base += drift;
+      }
+      auto now = std::chrono::system_clock::to_time_t(frame_time_);
+      scheduler_.rebase(alarm_scheduler::minute(*std::localtime(&now)));
+    }
+  }
+  wall_reference_ = frame_time_;
+  steady_reference_ = steady_time_;
+}
+
+void wall_clock::check_alarms()
+{
+  std::size_t missed;
+  bool due;
+  auto minute = alarm_scheduler::minute(now_);
+  prepare_sequences(minute);
+  if (scheduler_.advance(minute, missed, due))
+  {
+    bool will_alarm = false;
+    if (has_alarms_ && (due || (missed != 0 && fire_missed_alarms_)))
+    {
+      bell_alarm();
+      will_alarm = true;
+    }
+    if (has_chimes_ && now_.tm_min == 0 && !will_alarm)
+    {
+      bell_chime();
+    }
+  }
+  update_alarm_lead();
+}
+
+void wall_clock::update_alarm_lead()
+{
+  auto lead = scheduler_.lead(alarm_scheduler::minute(now_));
+  metrics_.next_alarm_lead.set(has_alarms_ && lead >= 0
+                                   ? lead * 60 - now_.tm_sec
+                                   : -1);
+}
+
+void wall_clock::prepare_sequences(std::int64_t minute)
+{
+  auto hour = minute - minute % 60 + 60;
+  if (has_chimes_ && hour - minute <= PRERENDER_LEAD &&
+      chime_sequence_.due != hour)
+  {
+    release_sequence(chime_sequence_);
+    chime_sequence_.due = hour;
+    chime_sequence_.job = std::async(
+        std::launch::async,
+        [&chimes = chimes_, rate = sample_rate_,
+         count = chime_count((now_.tm_hour + 1) % 24),
+         pitch = 12 - std::abs((now_.tm_hour + 1) % 24 - 12)]()
+        {
+          std::vector<chime::NOTE> notes;
+          for (int i = 0; i < count; ++i)
+          {
+            notes.push_back({&chimes[pitch], 1.0f,
+                             std::size_t((i * 1.5f + 0.0f) * rate)});
+          }
+          return chime::sequence(notes);
+        });
+  }
+  else if (chime_sequence_.due < minute)
+  {
+    release_sequence(chime_sequence_);
+  }
+  // Measured from the minute before, an alarm of this very minute is due in
+  // 0 minutes rather than a week, so its sequence is kept for bell_alarm.
+  auto lead = scheduler_.lead(minute - 1) - 1;
+  if (has_alarms_ && lead >= 0 && lead <= PRERENDER_LEAD)
+  {
+    if (!alarm_sequence_.voice && !alarm_sequence_.job.valid())
+    {
+      alarm_sequence_.job = std::async(
+          std::launch::async,
+          [&chimes = chimes_, rate = sample_rate_]()
+          {
+            std::vector<chime::NOTE> notes;
+            for (int i = 0; i < 13; ++i)
+            {
+              notes.push_back({&chimes[i], (i + 1) / 13.0f,
+                               std::size_t((i * 4.0f + 0.0f) * rate)});
+              notes.push_back({&chimes[i], (i + 1) / 26.0f,
+                               std::size_t((i * 4.0f + 1.0f) * rate)});
+            }
+            return chime::sequence(notes);
+          });
+    }
+  }
+  else
+  {
+    release_sequence(alarm_sequence_);
+  }
 }
 
-float wall_clock::get_volume()
+const chime *wall_clock::take_sequence(SEQUENCE &sequence)
 {
-  return (volume_ / 100.0f) * (whisper_ ? tense_ : 1.0f) * 0.5f;
+  if (sequence.job.valid() &&
+      sequence.job.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready)
+  {
+    sequence.voice = std::make_unique<chime>(sequence.job.get());
+  }
+  return sequence.voice.get();
 }
 
-int wall_clock::chime_count(int hour)
+void wall_clock::release_sequence(SEQUENCE &sequence)
 {
-  return hour % 12 != 0 ? hour % 12 : 12;
+  if (sequence.voice)
+  {
+    SDL_LockAudioDevice(audio_device_);
+    bool playing = std::any_of(strikes_.begin(), strikes_.end(),
+                               [&](const auto &strike)
+                               { return strike.voice == sequence.voice.get(); });
+    SDL_UnlockAudioDevice(audio_device_);
+    if (playing)
+    {
+      return;
+    }
+    sequence.voice.reset();
+  }
+  if (sequence.job.valid())
+  {
+    sequence.job.wait();
+    sequence.job = {};
+  }
+  sequence.due = -1;
 }
 
-const char *wall_clock::ampm(int hour) { return hour < 12 ? " AM" : " PM"; }
-
-void wall_clock::run()
+void wall_clock::redraw(const bool second_only)
 {
-  for (;;)
+  if (suspended())
+  {
+    return;
+  }
+  trace::span span{second_only ? "redraw(second)" : "redraw"};
+  auto begin = std::chrono::steady_clock::now();
+  background_.a = 255 * (dim_ ? tense_ : 1.0);
+  std::string second;
+  if (seconds_)
+  {
+    second = format_second(now_);
+  }
+  std::stringstream sDebug;
+  if (debug_)
+  {
+    report_audio(sDebug);
+  }
+  std::string time;
+  std::string weekday;
+  std::string date;
+  std::string info;
+  if (!second_only)
   {
-    auto now = std::chrono::system_clock::now();
-    auto tmp =
-        now.time_since_epoch().count() % std::chrono::system_clock::period::den;
-    now = now - std::chrono::system_clock::duration{tmp};
-    if (now != frame_time_)
+    time = format_time(now_);
+    for (const auto &row : rows_)
     {
-      frame_time_ = now;
-      tick();
+      switch (row.kind)
+      {
+      case ROW_WEEKDAY:
+        weekday = format_weekday(now_);
+        break;
+      case ROW_DATE:
+        date = format_date(now_);
+        break;
+      case ROW_OPTIONS:
+        info = format_options();
+        break;
+      }
     }
-    else
+  }
+
+  // The text is the same on every screen; only the fonts differ, and screens
+  // whose fonts match share the rasterized lines through prepared_.
+  for (auto &screen : screens_)
+  {
+    if (screen->suspended)
+    {
+      continue;
+    }
+    if (analog_)
+    {
+      // The analog face shows the time by itself; of the lines only the
+      // debug one is drawn over it.
+      if (!screen->face)
+      {
+        build_face(*screen);
+      }
+      if (debug_)
+      {
+        draw_text(screen->line_debug, sDebug.str(), screen->font_small,
+                  screen->scale_small);
+      }
+      continue;
+    }
+    if (seconds_)
+    {
+      draw_digits(*screen, screen->line_second, screen->transition_second,
+                  second);
+    }
+    if (debug_)
+    {
+      draw_text(screen->line_debug, sDebug.str(), screen->font_small,
+                screen->scale_small);
+    }
+    if (second_only)
+    {
+      continue;
+    }
+    for (const auto &row : screen->plan)
     {
-      SDL_Event event;
-      if (SDL_WaitEventTimeout(
-              &event, 1000 - (tmp * 1000 /
-                              std::chrono::system_clock::period::den)) == 1)
+      switch (row.kind)
       {
-        if (handle_event(&event) < 0)
+      case ROW_TIME:
+        if (!time_24_)
         {
-          break;
+          draw_text(screen->line_ampm, ampm(now_.tm_hour),
+                    screen->font_medium, screen->scale_medium);
         }
+        draw_digits(*screen, screen->line_time, screen->transition_time,
+                    time);
+        break;
+      case ROW_WEEKDAY:
+        draw_text(screen->line_weekday, weekday, screen->font_medium,
+                  screen->scale_medium);
+        break;
+      case ROW_DATE:
+        draw_text(screen->line_date, date, screen->font_medium,
+                  screen->scale_medium);
+        break;
+      case ROW_OPTIONS:
+        draw_text(screen->line_options, info, screen->font_small,
+                  screen->scale_small);
+        break;
       }
     }
   }
+  publish();
+  metrics_.redraw.observe(std::chrono::steady_clock::now() - begin);
 }
 
-int wall_clock::handle_event(SDL_Event *event)
+wall_clock::FRAME &wall_clock::begin_frame(const SCREEN &screen, FRAME &frame)
 {
-  int iResult = 0;
-  switch (event->type)
+  frame.width = screen.width;
+  frame.height = screen.height;
+  frame.display = screen.display >= 0 ? screen.display : display_;
+  frame.fullscreen = fullscreen_;
+  frame.hide_cursor = hide_cursor_;
+  frame.background = background_;
+  frame.text_color = text_color_;
+  frame.alpha = 255 * (dim_ ? tense_ : 1.0);
+  // Against burn-in the whole layout wanders on a Lissajous figure, a pixel
+  // at a time every few minutes. The periods grow with the distance, so
+  // even at its fastest it moves a pixel in no less than period / 2 pi, about
+  // three and a half minutes.
+  frame.shift = {0, 0};
+  if (pixel_shift_ > 0)
   {
-  case SDL_QUIT:
-    iResult = -1;
-    break;
-  case SDL_KEYUP:
-    switch (event->key.keysym.scancode)
+    auto time = std::chrono::system_clock::to_time_t(frame_time_);
+    auto turn = 8.0f * std::atan(1.0f);
+    auto period_x = std::time_t(SHIFT_PERIOD_X) * pixel_shift_;
+    auto period_y = std::time_t(SHIFT_PERIOD_Y) * pixel_shift_;
+    frame.shift = {
+        int(std::lround(pixel_shift_ *
+                        std::sin(turn * (time % period_x) / period_x))),
+        int(std::lround(pixel_shift_ *
+                        std::sin(turn * (time % period_y) / period_y)))};
+  }
+  frame.lines.clear();
+  frame.atlas = screen.atlas_medium;
+  frame.has_stopwatch = has_stopwatch();
+  frame.stopwatch = stopwatch_state();
+  frame.stopwatch_x = screen.width / 2;
+  frame.stopwatch_y = 0;
+  frame.stopwatch_align = ALIGN_CENTER;
+  frame.stopwatch_scale = screen.scale_medium;
+  frame.transition = transition_;
+  frame.digits = screen.atlas_big;
+  frame.distance = sdf_ ? distance_ : nullptr;
+  frame.transitions.clear();
+  frame.face = analog_ ? screen.face : nullptr;
+  frame.face_time = (now_.tm_hour * 60 + now_.tm_min) * 60 + now_.tm_sec;
+  frame.second_hand = seconds_;
+  frame.sweep = sweep_;
+  frame.requested = command_received_;
+  frame.tick = steady_time_;
+  return frame;
+}
+
+void wall_clock::publish()
+{
+  if (screens_.empty())
+  {
+    return;
+  }
+  auto &frames = frames_.back();
+  frames.resize(screens_.size());
+  for (std::size_t i = 0; i < screens_.size(); ++i)
+  {
+    place_lines(*screens_[i], begin_frame(*screens_[i], frames[i]));
+  }
+  frames_.publish();
+  SDL_Event event{};
+  event.type = frame_event_;
+  SDL_PushEvent(&event);
+}
+
+void wall_clock::place_lines(const SCREEN &screen, FRAME &frame)
+{
+  auto place = [&](const LINE &line, int x, int y)
+  {
+    frame.lines.push_back({line.surface, {x, y, line.size.x, line.size.y}});
+    if (!line.surface && frame.distance)
     {
-    case SDL_SCANCODE_F1:
-      if (SDL_OpenURL(help_path_.c_str()) != 0)
+      frame.lines.back().text = line.text;
+      frame.lines.back().scale =
+          line.size.y / float(frame.distance->measure("").y);
+    }
+  };
+  auto now = std::chrono::steady_clock::now();
+  auto animate = [&](const LINE &line, const TRANSITION &transition)
+  {
+    if (frame.transition != TRANSITION_NONE && frame.digits &&
+        transition.to == line.text && transitioning(transition, now))
+    {
+      frame.transitions.push_back(transition);
+      frame.transitions.back().line = frame.lines.size() - 1;
+    }
+  };
+  if (frame.face)
+  {
+    if (debug_)
+    {
+      place(screen.line_debug, 0, 0);
+    }
+    return;
+  }
+  // The stopwatch is only shown in the row of the date.
+  frame.has_stopwatch = false;
+  for (const auto &row : screen.plan)
+  {
+    switch (row.kind)
+    {
+    case ROW_TIME:
+    {
+      int width = screen.line_time.size.x +
+                  (seconds_ ? screen.line_second.size.x : 0) +
+                  (time_24_ ? 0 : screen.line_ampm.size.x);
+      int x = row.x - width * row.align / 2;
+      place(screen.line_time, x, row.y);
+      animate(screen.line_time, screen.transition_time);
+      x += screen.line_time.size.x;
+      if (seconds_)
       {
-        throw std::runtime_error("SDL_OpenURL(help)");
+        place(screen.line_second, x, row.y);
+        animate(screen.line_second, screen.transition_second);
+        x += screen.line_second.size.x;
+      }
+      if (!time_24_)
+      {
+        place(screen.line_ampm, x,
+              row.y + (screen.line_time.size.y - screen.line_ampm.size.y) / 2);
       }
       break;
-    case SDL_SCANCODE_ESCAPE:
-      iResult = -1;
-      break;
-    case SDL_SCANCODE_SPACE:
-      silent();
-      break;
-    case SDL_SCANCODE_R:
-      test_bell();
-      break;
-    case SDL_SCANCODE_RETURN:
-      read_config();
-      redraw(false);
-      break;
-    case SDL_SCANCODE_0:
-      start_timer(0);
-      break;
-    case SDL_SCANCODE_1:
-      start_timer(1);
-      break;
-    case SDL_SCANCODE_2:
-      start_timer(2);
-      break;
-    case SDL_SCANCODE_3:
-      start_timer(3);
-      break;
-    case SDL_SCANCODE_4:
-      start_timer(4);
-      break;
-    case SDL_SCANCODE_5:
-      start_timer(5);
-      break;
-    case SDL_SCANCODE_6:
-      start_timer(6);
-      break;
-    case SDL_SCANCODE_7:
-      start_timer(7);
+    }
+    case ROW_WEEKDAY:
+      place(screen.line_weekday,
+            row.x - screen.line_weekday.size.x * row.align / 2, row.y);
       break;
-    case SDL_SCANCODE_8:
-      start_timer(8);
+    case ROW_DATE:
+      place(screen.line_date, row.x - screen.line_date.size.x * row.align / 2,
+            row.y);
       break;
-    case SDL_SCANCODE_9:
-      start_timer(9);
+    case ROW_STOPWATCH:
+      frame.has_stopwatch = true;
+      frame.stopwatch_x = row.x;
+      frame.stopwatch_y = row.y;
+      frame.stopwatch_align = row.align;
       break;
-    case SDL_SCANCODE_MINUS:
-      stop_timer();
+    case ROW_OPTIONS:
+      place(screen.line_options,
+            row.x - screen.line_options.size.x * row.align / 2, row.y);
       break;
     }
-    break;
-  case SDL_MOUSEBUTTONUP:
-    iResult = -1;
-    break;
-  case SDL_FINGERUP:
-    iResult = -1;
-    break;
-  case SDL_WINDOWEVENT:
-    switch (event->window.event)
+  }
+  if (debug_)
+  {
+    place(screen.line_debug, 0, 0);
+  }
+}
+
+void wall_clock::compose(SCREEN &screen)
+{
+  trace::span span{"compose"};
+  const auto &frame = screen.frame;
+  if (!frame.width)
+  {
+    return;
+  }
+  if (SDL_SetRenderDrawColor(screen.renderer, frame.background.r,
+                             frame.background.g, frame.background.b,
+                             frame.background.a) != 0 ||
+      SDL_RenderClear(screen.renderer) != 0)
+  {
+    throw std::runtime_error("Clear Background");
+  }
+  // Clearing ignores the viewport, so moving it shifts everything drawn
+  // after without any extra pass.
+  SDL_Rect viewport{frame.shift.x, frame.shift.y, frame.width, frame.height};
+  if (SDL_RenderSetViewport(screen.renderer, &viewport) != 0)
+  {
+    throw std::runtime_error("SDL_RenderSetViewport");
+  }
+  auto now = std::chrono::steady_clock::now();
+  Uint8 alpha = std::lround(fade(screen, now));
+  auto color = frame.text_color;
+  color.a = alpha;
+  if (frame.face)
+  {
+    if (screen.dial_face != frame.face)
+    {
+      draw_dial(screen);
+    }
+    auto size = frame.face->size();
+    SDL_Rect rect{(frame.width - size) / 2, (frame.height - size) / 2, size,
+                  size};
+    if (SDL_SetTextureColorMod(screen.dial, frame.text_color.r,
+                               frame.text_color.g, frame.text_color.b) != 0 ||
+        SDL_SetTextureAlphaMod(screen.dial, alpha) != 0 ||
+        SDL_RenderCopy(screen.renderer, screen.dial, nullptr, &rect) != 0)
+    {
+      throw std::runtime_error("SDL_RenderCopy");
+    }
+    // A sweeping second hand moves on between the frames of whole seconds.
+    auto seconds = frame.face_time;
+    if (frame.sweep && frame.second_hand)
+    {
+      seconds += std::min(
+          1.0f, std::chrono::duration<float>(now - frame.tick).count());
+    }
+    screen.vertices.clear();
+    screen.indices.clear();
+    frame.face->hands(seconds, frame.second_hand,
+                      {rect.x + size / 2.0f, rect.y + size / 2.0f}, color,
+                      screen.vertices, screen.indices);
+    if (SDL_SetRenderDrawBlendMode(screen.renderer, SDL_BLENDMODE_BLEND) != 0 ||
+        SDL_RenderGeometry(screen.renderer, nullptr, screen.vertices.data(),
+                           screen.vertices.size(), screen.indices.data(),
+                           screen.indices.size()) != 0)
+    {
+      throw std::runtime_error("SDL_RenderGeometry");
+    }
+  }
+  // Lines in transition are drawn from the digit atlas, all of them with one
+  // draw call.
+  bool animating = false;
+  for (std::size_t i = 0; i < frame.lines.size(); ++i)
+  {
+    const auto &line = frame.lines[i];
+    if (std::any_of(frame.transitions.begin(), frame.transitions.end(),
+                    [&](const TRANSITION &transition)
+                    {
+                      return transition.line == i &&
+                             transitioning(transition, now);
+                    }))
+    {
+      animating = true;
+      continue;
+    }
+    auto texture = line.surface ? this->texture(screen, line.surface.get())
+                                : nullptr;
+    if (texture &&
+        (SDL_SetTextureColorMod(texture, frame.text_color.r,
+                                frame.text_color.g, frame.text_color.b) != 0 ||
+         SDL_SetTextureAlphaMod(texture, alpha) != 0 ||
+         SDL_RenderCopy(screen.renderer, texture, nullptr, &line.rect) != 0))
+    {
+      throw std::runtime_error("SDL_RenderCopy");
+    }
+  }
+  if (frame.distance)
+  {
+    // The text is white with premultiplied alpha, so colour and brightness
+    // are both applied to its colour.
+    SDL_Rect rect{0, 0, screen.text_size.x, screen.text_size.y};
+    if (SDL_SetTextureColorMod(screen.text[0], frame.text_color.r * alpha / 255,
+                               frame.text_color.g * alpha / 255,
+                               frame.text_color.b * alpha / 255) != 0 ||
+        SDL_SetTextureAlphaMod(screen.text[0], alpha) != 0 ||
+        SDL_RenderCopy(screen.renderer, screen.text[0], nullptr, &rect) != 0)
+    {
+      throw std::runtime_error("SDL_RenderCopy");
+    }
+  }
+  if (animating)
+  {
+    screen.vertices.clear();
+    screen.indices.clear();
+    for (const auto &transition : frame.transitions)
+    {
+      if (transitioning(transition, now))
+      {
+        animate(screen, transition, color, now);
+      }
+    }
+    if (!screen.vertices.empty() &&
+        SDL_RenderGeometry(screen.renderer,
+                           texture(screen, frame.digits->surface().get()),
+                           screen.vertices.data(), screen.vertices.size(),
+                           screen.indices.data(), screen.indices.size()) != 0)
+    {
+      throw std::runtime_error("SDL_RenderGeometry");
+    }
+  }
+  if (frame.has_stopwatch && frame.atlas)
+  {
+    char stopwatch[32];
+    format_stopwatch(frame.stopwatch, stopwatch, sizeof(stopwatch));
+    auto width = frame.atlas->measure(stopwatch).x * frame.stopwatch_scale;
+    screen.vertices.clear();
+    screen.indices.clear();
+    frame.atlas->layout(stopwatch,
+                        frame.stopwatch_x - width * frame.stopwatch_align / 2,
+                        frame.stopwatch_y, color, screen.vertices,
+                        screen.indices, frame.stopwatch_scale);
+    if (!screen.vertices.empty() &&
+        SDL_RenderGeometry(screen.renderer,
+                           texture(screen, frame.atlas->surface().get()),
+                           screen.vertices.data(), screen.vertices.size(),
+                           screen.indices.data(), screen.indices.size()) != 0)
+    {
+      throw std::runtime_error("SDL_RenderGeometry");
+    }
+  }
+  if (animating)
+  {
+    // A frame is late when the one before it, also of the transition, was
+    // presented more than a refresh and a half earlier.
+    metrics_.transition_frame.observe(std::chrono::steady_clock::now() - now);
+    if (screen.present_time > frame.transitions.front().start &&
+        (now - screen.present_time) * 2 >
+            std::chrono::milliseconds(screen.frame_interval * 3))
+    {
+      metrics_.transition_late_frames.add();
+    }
+  }
+  SDL_RenderPresent(screen.renderer);
+  screen.present_time = std::chrono::steady_clock::now();
+  if (frame.tick != screen.presented_tick)
+  {
+    screen.presented_tick = frame.tick;
+    metrics_.tick_to_present.observe(screen.present_time - frame.tick);
+  }
+  if (frame.requested != screen.presented_request)
+  {
+    screen.presented_request = frame.requested;
+    present_latency_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                           screen.present_time - frame.requested)
+                           .count();
+  }
+}
+
+void wall_clock::draw_dial(SCREEN &screen)
+{
+  // The dial changes only with the size of the screen, so it is drawn once
+  // into a texture, in white like the text, and tinted when composing.
+  trace::span span{"draw_dial"};
+  const auto &face = *screen.frame.face;
+  if (screen.dial)
+  {
+    SDL_DestroyTexture(screen.dial);
+  }
+  screen.dial = SDL_CreateTexture(screen.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                  SDL_TEXTUREACCESS_TARGET, face.size(),
+                                  face.size());
+  if (!screen.dial)
+  {
+    throw std::runtime_error("SDL_CreateTexture");
+  }
+  if (SDL_SetTextureBlendMode(screen.dial, SDL_BLENDMODE_BLEND) != 0 ||
+      SDL_SetRenderTarget(screen.renderer, screen.dial) != 0)
+  {
+    throw std::runtime_error("SDL_SetRenderTarget");
+  }
+  // The ticks are written rather than blended, so their feathered edges keep
+  // their colour and only lose alpha.
+  const auto &ticks = face.ticks();
+  if (SDL_SetRenderDrawBlendMode(screen.renderer, SDL_BLENDMODE_NONE) != 0 ||
+      SDL_SetRenderDrawColor(screen.renderer, 255, 255, 255, 0) != 0 ||
+      SDL_RenderClear(screen.renderer) != 0 ||
+      SDL_RenderGeometry(screen.renderer, nullptr, ticks.vertices.data(),
+                         ticks.vertices.size(), ticks.indices.data(),
+                         ticks.indices.size()) != 0)
+  {
+    throw std::runtime_error("SDL_RenderGeometry");
+  }
+  for (const auto &numeral : face.numerals())
+  {
+    auto texture =
+        SDL_CreateTextureFromSurface(screen.renderer, numeral.surface.get());
+    if (!texture)
+    {
+      throw std::runtime_error("SDL_CreateTextureFromSurface");
+    }
+    auto result =
+        SDL_RenderCopy(screen.renderer, texture, nullptr, &numeral.rect);
+    SDL_DestroyTexture(texture);
+    if (result != 0)
+    {
+      throw std::runtime_error("SDL_RenderCopy");
+    }
+  }
+  if (SDL_SetRenderTarget(screen.renderer, nullptr) != 0)
+  {
+    throw std::runtime_error("SDL_SetRenderTarget");
+  }
+  screen.dial_face = screen.frame.face;
+}
+
+void wall_clock::draw_distance(SCREEN &screen)
+{
+  // SDL's renderers have no shaders to cut a distance field at 0.5, so it is
+  // done by blending into two textures in turn: draw the glyphs scaled with
+  // linear filtering, subtract 0.5 - 0.5 / k, and double the result until it
+  // is k times as much, which turns the field into a one pixel wide edge.
+  trace::span span{"draw_distance"};
+  const auto &frame = screen.frame;
+  if (frame.width != screen.text_size.x || frame.height != screen.text_size.y)
+  {
+    for (auto &texture : screen.text)
+    {
+      if (texture)
+      {
+        SDL_DestroyTexture(texture);
+      }
+      texture = SDL_CreateTexture(screen.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                  SDL_TEXTUREACCESS_TARGET, frame.width,
+                                  frame.height);
+      if (!texture)
+      {
+        throw std::runtime_error("SDL_CreateTexture");
+      }
+    }
+    screen.text_size = {frame.width, frame.height};
+  }
+  screen.vertices.clear();
+  screen.indices.clear();
+  float scale = 0.0f;
+  for (const auto &line : frame.lines)
+  {
+    if (!line.surface && !line.text.empty())
+    {
+      frame.distance->layout(line.text.c_str(), line.rect.x, line.rect.y,
+                             {255, 255, 255, 255}, screen.vertices,
+                             screen.indices, line.scale);
+      scale = std::max(scale, line.scale);
+    }
+  }
+  // Beyond eight doublings the 8-bit field itself is the limit; with a
+  // DISTANCE_SIZE atlas that is only reached by text taller than an 8K
+  // screen.
+  int doublings = std::clamp(
+      int(std::ceil(std::log2(2 * frame.distance->spread() * scale))), 1, 8);
+  Uint8 cut = std::lround(255 * (0.5f - 0.5f / (1 << doublings)));
+  auto [add, subtract, maximum, over] = distance_blend_modes();
+  auto clear = [&](SDL_Texture *target)
+  {
+    if (SDL_SetRenderTarget(screen.renderer, target) != 0 ||
+        SDL_SetRenderDrawBlendMode(screen.renderer, SDL_BLENDMODE_NONE) != 0 ||
+        SDL_SetRenderDrawColor(screen.renderer, 0, 0, 0, 0) != 0 ||
+        SDL_RenderClear(screen.renderer) != 0)
+    {
+      throw std::runtime_error("SDL_SetRenderTarget");
+    }
+  };
+  // The glyphs' margins overlap their neighbours, where the larger distance
+  // wins; renderers without that blend operation let the later glyph win.
+  auto atlas = texture(screen, frame.distance->surface().get());
+  auto current = doublings % 2;
+  clear(screen.text[current]);
+  if ((SDL_SetTextureBlendMode(atlas, maximum) != 0 &&
+       SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_NONE) != 0) ||
+      SDL_SetTextureScaleMode(atlas, SDL_ScaleModeLinear) != 0 ||
+      (!screen.vertices.empty() &&
+       SDL_RenderGeometry(screen.renderer, atlas, screen.vertices.data(),
+                          screen.vertices.size(), screen.indices.data(),
+                          screen.indices.size()) != 0) ||
+      SDL_SetRenderDrawBlendMode(screen.renderer, subtract) != 0 ||
+      SDL_SetRenderDrawColor(screen.renderer, cut, cut, cut, cut) != 0 ||
+      SDL_RenderFillRect(screen.renderer, nullptr) != 0)
+  {
+    throw std::runtime_error("SDL_RenderGeometry");
+  }
+  for (int i = 0; i < doublings; ++i)
+  {
+    auto source = screen.text[current];
+    current = 1 - current;
+    clear(screen.text[current]);
+    if (SDL_SetTextureBlendMode(source, add) != 0 ||
+        SDL_RenderCopy(screen.renderer, source, nullptr, nullptr) != 0 ||
+        SDL_RenderCopy(screen.renderer, source, nullptr, nullptr) != 0)
+    {
+      throw std::runtime_error("SDL_RenderCopy");
+    }
+  }
+  if (SDL_SetRenderTarget(screen.renderer, nullptr) != 0 ||
+      SDL_SetTextureBlendMode(screen.text[0], over) != 0)
+  {
+    throw std::runtime_error("SDL_SetRenderTarget");
+  }
+}
+
+std::array<SDL_BlendMode, 4> wall_clock::distance_blend_modes()
+{
+  // Adding, subtracting from the target, keeping the larger value, and
+  // drawing premultiplied text over the background.
+  return {SDL_ComposeCustomBlendMode(
+              SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD,
+              SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD),
+          SDL_ComposeCustomBlendMode(
+              SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE,
+              SDL_BLENDOPERATION_REV_SUBTRACT, SDL_BLENDFACTOR_ONE,
+              SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_REV_SUBTRACT),
+          SDL_ComposeCustomBlendMode(
+              SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE,
+              SDL_BLENDOPERATION_MAXIMUM, SDL_BLENDFACTOR_ONE,
+              SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_MAXIMUM),
+          SDL_ComposeCustomBlendMode(
+              SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+              SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE,
+              SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD)};
+}
+
+void wall_clock::build_face(SCREEN &screen)
+{
+  // Screens of the same size share their face, like their atlases.
+  trace::span span{"build_face"};
+  auto size = std::min(screen.width, screen.height) * 9 / 10;
+  for (const auto &other : screens_)
+  {
+    if (other.get() != &screen && other->face &&
+        other->face->size() == size)
+    {
+      screen.face = other->face;
+      return;
+    }
+  }
+  auto font_dial = screen.font_dial;
+  screen.font_dial = fonts_.open(size / 10);
+  fonts_.close(font_dial);
+  auto face = std::make_shared<clock_face>();
+  face->build(size, screen.font_dial);
+  screen.face = face;
+}
+
+float wall_clock::fade(const SCREEN &screen,
+                       std::chrono::steady_clock::time_point now)
+{
+  auto progress = std::chrono::duration<float>(now - screen.fade_start) /
+                  std::chrono::milliseconds(FADE_TIME);
+  if (progress >= 1.0f)
+  {
+    return screen.frame.alpha;
+  }
+  return screen.fade_from + (screen.frame.alpha - screen.fade_from) * progress;
+}
+
+bool wall_clock::animated(const SCREEN &screen,
+                          std::chrono::steady_clock::time_point now)
+{
+  return (screen.frame.has_stopwatch && screen.frame.stopwatch.running) ||
+         (screen.frame.face && screen.frame.sweep &&
+          screen.frame.second_hand) ||
+         now - screen.fade_start < std::chrono::milliseconds(FADE_TIME) ||
+         std::any_of(screen.frame.transitions.begin(),
+                     screen.frame.transitions.end(),
+                     [&](const TRANSITION &transition)
+                     { return transitioning(transition, now); });
+}
+
+bool wall_clock::transitioning(const TRANSITION &transition,
+                               std::chrono::steady_clock::time_point now)
+{
+  return now - transition.start < std::chrono::milliseconds(TRANSITION_TIME);
+}
+
+void wall_clock::animate(SCREEN &screen, const TRANSITION &transition,
+                         const SDL_Color &color,
+                         std::chrono::steady_clock::time_point now)
+{
+  // Only the glyphs that change move: a slide pushes the old one up and out
+  // of the line while the new one follows from below, a flip folds the old
+  // one to its middle and unfolds the new one from there.
+  const auto &frame = screen.frame;
+  const auto &digits = *frame.digits;
+  const auto &rect = frame.lines[transition.line].rect;
+  float progress = std::chrono::duration<float>(now - transition.start) /
+                   std::chrono::milliseconds(TRANSITION_TIME);
+  progress = progress * progress * (3.0f - 2.0f * progress);
+  float height = rect.h;
+  float scale = height / digits.measure("").y;
+  float from_x = rect.x;
+  float to_x = rect.x;
+  for (std::size_t i = 0; i < transition.to.size(); ++i)
+  {
+    char from = transition.from[i];
+    char to = transition.to[i];
+    float from_w = digits.width(from) * scale;
+    float to_w = digits.width(to) * scale;
+    if (from == to)
+    {
+      digits.glyph(to, {to_x, float(rect.y), to_w, height}, 0.0f, 1.0f, color,
+                   screen.vertices, screen.indices);
+    }
+    else if (frame.transition == TRANSITION_SLIDE)
     {
-    case SDL_WINDOWEVENT_RESIZED:
-      set_window();
-      redraw(false);
-      break;
+      float shift = height * progress;
+      digits.glyph(from, {from_x, float(rect.y), from_w, height - shift},
+                   progress, 1.0f, color, screen.vertices, screen.indices);
+      digits.glyph(to, {to_x, rect.y + height - shift, to_w, shift}, 0.0f,
+                   progress, color, screen.vertices, screen.indices);
     }
-    break;
+    else if (progress < 0.5f)
+    {
+      float fold = height * progress;
+      digits.glyph(from, {from_x, rect.y + fold, from_w, height - 2 * fold},
+                   0.0f, 1.0f, color, screen.vertices, screen.indices);
+    }
+    else
+    {
+      float fold = height * (1.0f - progress);
+      digits.glyph(to, {to_x, rect.y + fold, to_w, height - 2 * fold}, 0.0f,
+                   1.0f, color, screen.vertices, screen.indices);
+    }
+    from_x += from_w;
+    to_x += to_w;
   }
-  return iResult;
 }
 
-void wall_clock::read_config()
+void wall_clock::draw_digits(SCREEN &screen, LINE &line,
+                             TRANSITION &transition, const std::string &text)
 {
-  volume_ = 100;
-  display_ = -1;
-  text_color_ = {255, 255, 255, 255};
-  background_ = {0, 0, 0, 255};
-  hide_cursor_ = true;
-  fullscreen_ = true;
-  dim_ = true;
-  whisper_ = true;
-  has_chimes_ = false;
-  has_alarms_ = false;
-  has_sound_info_ = true;
-  weekday_ = "%A";
-  date_ = "%m/%d/%Y";
-  time_24_ = true;
-  seconds_ = true;
-  pad_hour_ = true;
-  pad_minute_ = true;
-  pad_second_ = true;
-  pad_year_ = true;
-  pad_month_ = true;
-  pad_day_ = true;
-  timer_interval_ = 10;
-  alarms_.clear();
-  next_alarm_ = std::size_t(-1);
-  const char *home_directory = getenv(HOME);
-  if (home_directory)
+  // The old text of the line is where a transition starts from. The digit
+  // atlas is only built once a transition needs it, and is shared like the
+  // medium one.
+  if (transition_ != TRANSITION_NONE && !(sdf_ && distance_) &&
+      !line.text.empty() &&
+      line.text != text && line.text.size() == text.size())
   {
-    std::string conf_path{home_directory};
-    conf_path += "/.clock.conf";
-    std::ifstream config_file(conf_path.c_str());
-    std::string config;
-    while (std::getline(config_file, config))
+    transition = {line.text, text, std::chrono::steady_clock::now(), 0};
+    for (const auto &other : screens_)
     {
-      std::istringstream pair_stream{config};
-      std::string key;
-      pair_stream >> key;
-      auto handler = config_handlers_.find(key);
-      if (handler != config_handlers_.end())
+      if (!screen.atlas_big && other.get() != &screen &&
+          other->font_big == screen.font_big && other->atlas_big)
       {
-        handler->second(pair_stream);
+        screen.atlas_big = other->atlas_big;
       }
     }
-    bool will_alarm = false;
-    std::size_t alarm_time =
-        (now_.tm_wday * 24 + now_.tm_hour) * 60 + now_.tm_min;
-    auto alarm = alarms_.lower_bound(alarm_time);
-    if (alarm != alarms_.end() && *alarm == alarm_time)
+    if (!screen.atlas_big)
     {
-      if (has_alarms_)
-      {
-        bell_alarm();
-        will_alarm = true;
-      }
-      ++alarm;
+      trace::span span{"digit_atlas"};
+      auto atlas = std::make_shared<glyph_atlas>();
+      atlas->build(screen.font_big, "0123456789: ", true);
+      screen.atlas_big = atlas;
     }
-    if (has_chimes_)
+  }
+  draw_text(line, text, screen.font_big, screen.scale_big);
+}
+
+void wall_clock::draw_text(LINE &line, const std::string &text, TTF_Font *font,
+                           float scale)
+{
+  if (sdf_ && distance_)
+  {
+    // Distance field text is only measured here; the render thread draws it
+    // from the atlas at the size of the font.
+    auto height = int(std::lround(TTF_FontHeight(font) * scale));
+    if (line.surface || line.font != font || line.text != text ||
+        line.size.y != height)
     {
-      if (now_.tm_min == 0 && !will_alarm)
-      {
-        bell_chime();
-      }
+      auto width = distance_->measure(text.c_str()).x * height /
+                   distance_->measure("").y;
+      line = {text, font, nullptr, {width, height}};
     }
-    if (alarm == alarms_.end())
+    return;
+  }
+  auto matches = [&](const LINE &line)
+  { return line.surface && line.font == font && line.text == text; };
+  if (!matches(line))
+  {
+    // Lines prepared for this second, or drawn since, are kept until the
+    // next tick so other screens with the same font can share them.
+    auto prepared = std::find_if(prepared_.begin(), prepared_.end(), matches);
+    if (prepared != prepared_.end())
     {
-      alarm = alarms_.begin();
+      line = *prepared;
     }
-    if (alarm != alarms_.end())
+    else
     {
-      next_alarm_ = *alarm;
+      rasterize(line, text, font);
+      prepared_.push_back(line);
     }
   }
-  SDL_ShowCursor(hide_cursor_ ? SDL_DISABLE : SDL_ENABLE);
-  if (display_ >= 0 && SDL_GetWindowDisplayIndex(wnd_) != display_)
+  // Screens share capped fonts at different scales, so the size of a line
+  // is its own.
+  line.size = {int(std::lround(line.surface->w * scale)),
+               int(std::lround(line.surface->h * scale))};
+}
+
+void wall_clock::rasterize(LINE &line, const std::string &text,
+                           TTF_Font *font)
+{
+  // Text is rasterized in white; its colour and brightness are applied to
+  // the texture when composing, so changing them costs no font work.
+  // With max-glyph-size it is anti-aliased, as it may be scaled up.
+  trace::span span{"draw_text"};
+  auto surface =
+      max_glyph_size_
+          ? TTF_RenderText_Blended(font, text.c_str(), {255, 255, 255, 255})
+          : TTF_RenderText_Solid(font, text.c_str(), {255, 255, 255, 255});
+  if (!surface)
   {
-    set_display();
+    throw std::runtime_error("TTF_RenderText");
   }
-  else if (((SDL_GetWindowFlags(wnd_) & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP) != fullscreen_)
+  metrics_.text_bytes.add(surface->pitch * surface->h);
+  line = {text, font, {surface, SDL_FreeSurface}, {surface->w, surface->h}};
+}
+
+void wall_clock::forget_lines(SCREEN &screen)
+{
+  // The font cache may hand out a closed font's address again, so lines
+  // keyed by font pointer must not outlive a font change.
+  for (auto line : {&screen.line_second, &screen.line_time, &screen.line_ampm,
+                    &screen.line_weekday, &screen.line_date,
+                    &screen.line_options, &screen.line_debug})
   {
-    set_window();
+    line->font = nullptr;
   }
-  else if (lines_height_ != calculate_lines_height())
+  prepared_.clear();
+}
+
+bool wall_clock::has_date_line() { return date_ != "?" || has_stopwatch(); }
+
+void wall_clock::start_timer(int delay)
+{
+  if (current_timer_ < timers_.size())
   {
-    set_fonts();
+    start_timer(timers_[current_timer_].name, delay);
   }
-  else if (time_width_ != calculate_time_width())
+  else
   {
-    reset_big_font();
-    set_big_font();
+    start_timer(std::to_string(++timer_serial_), delay);
   }
 }
 
-void wall_clock::tick()
+void wall_clock::start_timer(const std::string &name, int delay)
 {
-  static std::time_t tPre = std::chrono::system_clock::to_time_t(
-      frame_time_ - std::chrono::minutes(1));
-  std::time_t t = std::chrono::system_clock::to_time_t(frame_time_);
-  if (tPre != t)
+  auto timer = std::find_if(timers_.begin(), timers_.end(),
+                            [&](const auto &timer)
+                            { return timer.name == name; });
+  if (timer == timers_.end())
   {
-    now_ = *std::localtime(&t);
-    auto pre = *std::localtime(&tPre);
-    if (pre.tm_min != now_.tm_min)
-    {
-      tense_ = std::max(0, 8 * 60 - std::abs(now_.tm_hour * 60 + now_.tm_min -
-                                             14 * 60)) /
-                   static_cast<float>(8 * 60) * 0.85f +
-               0.15f;
-      pitch_ = 12 - std::abs(now_.tm_hour - 12);
-      read_config();
-      redraw(false);
-    }
-    else if (timer_base_.time_since_epoch().count() != 0)
+    if (timers_.size() == TIMER_COUNT)
     {
-      redraw(false);
+      return;
     }
-    else if (seconds_)
+    int tag = 1;
+    while (std::any_of(timers_.begin(), timers_.end(),
+                       [&](const auto &timer)
+                       { return timer.tag == tag; }))
     {
-      redraw(true);
+      ++tag;
     }
-    tPre = t;
+    timer = timers_.insert(timers_.end(), {name, {}, tag, 0, 0});
   }
+  cancel(timer->tag);
+  timer->base = frame_time_ + std::chrono::seconds(delay * timer_interval_);
+  SDL_LockAudioDevice(audio_device_);
+  timer->origin = audio_position() +
+                  std::int64_t(delay) * timer_interval_ * sample_rate_ -
+                  (clock_.now() - frame_time_) *
+                      sample_rate_ / std::chrono::seconds(1);
+  SDL_UnlockAudioDevice(audio_device_);
+  timer->queued = -1;
+  queue_timer_bells(*timer);
+  current_timer_ = timer - timers_.begin();
 }
 
-void wall_clock::redraw(const bool second_only)
+void wall_clock::new_timer() { current_timer_ = timers_.size(); }
+
+void wall_clock::stop_timer()
 {
-  text_color_.a = 255 * (dim_ ? tense_ : 1.0);
-  background_.a = 255 * (dim_ ? tense_ : 1.0);
-  if (seconds_)
+  if (current_timer_ < timers_.size())
   {
-    std::stringstream sSecond;
-    sSecond << ":" << std::setfill('0') << std::setw(pad_second_ ? 2 : 0)
-            << now_.tm_sec;
-    draw_text(texture_second_, size_second_, sSecond.str(), font_big_,
-              text_color_);
+    stop_timer(timers_[current_timer_].name);
   }
-  if (!second_only)
-  {
-    total_height_ = 0;
+}
 
-    if (!time_24_)
+void wall_clock::stop_timer(const std::string &name)
+{
+  for (const auto &timer : timers_)
+  {
+    if (timer.name == name)
     {
-      auto ap = ampm(now_.tm_hour);
-      draw_text(texture_ampm_, size_ampm_, ap, font_medium_, text_color_);
+      cancel(timer.tag);
     }
+  }
+  timers_.erase(std::remove_if(timers_.begin(), timers_.end(),
+                               [&](const auto &timer)
+                               { return timer.name == name; }),
+                timers_.end());
+  current_timer_ = timers_.empty() ? 0 : timers_.size() - 1;
+  if (timers_.empty())
+  {
+    timer_serial_ = 0;
+  }
+  redraw(false);
+}
 
-    std::stringstream sTime;
-    sTime << std::setfill('0') << std::setw(pad_hour_ ? 2 : 0)
-          << (time_24_ ? now_.tm_hour : chime_count(now_.tm_hour)) << ":"
-          << std::setw(pad_minute_ ? 2 : 0) << now_.tm_min;
-    draw_text(texture_time_, size_time_, sTime.str(), font_big_, text_color_);
-    total_height_ += size_time_.y;
+bool wall_clock::has_stopwatch()
+{
+  return stopwatch_running_ ||
+         stopwatch_elapsed_ != std::chrono::steady_clock::duration::zero();
+}
 
-    if (weekday_ != "?")
-    {
-      std::stringstream sWeekday;
-      if (timer_base_.time_since_epoch().count() != 0)
-      {
-        int seconds = (frame_time_ - timer_base_) / std::chrono::seconds(1);
-        sWeekday << std::setfill('0') << (seconds < 0 ? "-" : " ")
-                 << std::setw(pad_minute_ ? 2 : 0) << std::abs(seconds) / 60 << ":"
-                 << std::setw(pad_second_ ? 2 : 0) << std::abs(seconds) % 60 << " ";
-        if (seconds == -2)
-        {
-          bell(3, 12, 1.0f);
-        }
-        else if (seconds >= 0 && seconds % timer_interval_ == 0)
-        {
-          bell(1, std::min(12, 2 + seconds / timer_interval_), 1.0f);
-        }
-      }
-      else
-      {
-        bool ctrl = false;
-        for (const auto &c : weekday_)
-        {
-          if (ctrl)
-          {
-            switch (c)
-            {
-            case 'A':
-              sWeekday << weekdays_full_[now_.tm_wday];
-              break;
-            case 'a':
-              sWeekday << weekdays_abbreviated_[now_.tm_wday];
-              break;
-            case 'w':
-              sWeekday << now_.tm_wday;
-              break;
-            case 'u':
-              sWeekday << (now_.tm_wday > 0 ? now_.tm_wday : 7);
-              break;
-            }
-            ctrl = false;
-          }
-          else if (c == '%')
-          {
-            ctrl = true;
-          }
-          else
-          {
-            sWeekday << c;
-          }
-        }
-      }
-      draw_text(texture_weekday_, size_weekday_, sWeekday.str(), font_medium_, text_color_);
-      total_height_ += size_weekday_.y;
-    }
+wall_clock::STOPWATCH wall_clock::stopwatch_state()
+{
+  return {stopwatch_running_,
+          stopwatch_start_,
+          stopwatch_elapsed_,
+          lap_count_,
+          lap_count_ > 0 ? laps_[(lap_count_ - 1) % LAP_COUNT]
+                         : std::chrono::steady_clock::duration::zero(),
+          pad_minute_};
+}
 
-    if (date_ != "?")
-    {
-      std::stringstream sDate;
-      sDate << std::setfill('0');
-      bool ctrl = false;
-      for (const auto &c : date_)
-      {
-        if (ctrl)
-        {
-          switch (c)
-          {
-          case 'm':
-            sDate << std::setw(pad_month_ ? 2 : 0) << now_.tm_mon + 1;
-            break;
-          case 'b':
-            sDate << months_[now_.tm_mon];
-            break;
-          case 'd':
-            sDate << std::setw(pad_day_ ? 2 : 0) << now_.tm_mday;
-            break;
-          case 'Y':
-            sDate << now_.tm_year + 1900;
-            break;
-          case 'y':
-            sDate << std::setw(pad_year_ ? 2 : 0) << now_.tm_year % 100;
-            break;
-          }
-          ctrl = false;
-        }
-        else if (c == '%')
-        {
-          ctrl = true;
-        }
-        else
-        {
-          sDate << c;
-        }
-      }
-      auto date = sDate.str();
-      draw_text(texture_date_, size_date_, date, font_medium_, text_color_);
-      total_height_ += size_date_.y;
-    }
+std::chrono::steady_clock::duration
+wall_clock::stopwatch_time(const STOPWATCH &stopwatch)
+{
+  return stopwatch.elapsed +
+         (stopwatch.running ? std::chrono::steady_clock::now() - stopwatch.start
+                            : std::chrono::steady_clock::duration::zero());
+}
 
-    if (has_sound_info_)
+void wall_clock::format_stopwatch(const STOPWATCH &stopwatch, char *text,
+                                  std::size_t size)
+{
+  auto format = [&](std::chrono::steady_clock::duration time)
+  {
+    int centiseconds = time / std::chrono::milliseconds(10);
+    return std::snprintf(text, size,
+                         stopwatch.pad_minute ? "%02d:%02d.%02d" : "%d:%02d.%02d",
+                         centiseconds / 6000, centiseconds / 100 % 60,
+                         centiseconds % 100);
+  };
+  auto length = format(stopwatch_time(stopwatch));
+  if (stopwatch.lap_count > 0 && length > 0 && std::size_t(length) < size)
+  {
+    text += length;
+    size -= length;
+    length = std::snprintf(text, size, " L%zu ", stopwatch.lap_count);
+    if (length > 0 && std::size_t(length) < size)
     {
-      std::stringstream sInfo;
-      sInfo << "\x5:" << (has_chimes_ ? '\x7' : '\x8') << "  "
-            << "\x6:" << (has_alarms_ ? '\x7' : '\x8') << " ";
-      if (next_alarm_ != std::size_t(-1))
-      {
-        auto day = next_alarm_ / (60 * 24);
-        auto hour = next_alarm_ / 60 % 24;
-        auto minute = next_alarm_ % 60;
-        sInfo << weekdays_abbreviated_[day]
-              << " " << std::setfill('0') << std::setw(pad_hour_ ? 2 : 0)
-              << (time_24_ ? hour : chime_count(hour)) << ':'
-              << std::setw(pad_minute_ ? 2 : 0) << minute
-              << (time_24_ ? "" : ampm(hour));
-      }
-      draw_text(texture_options_, size_options_, sInfo.str(), font_small_,
-                text_color_);
-      total_height_ += size_options_.y;
+      text += length;
+      size -= length;
+      format(stopwatch.lap);
     }
   }
-  if (SDL_SetRenderDrawColor(renderer_, background_.r, background_.g,
-                             background_.b, background_.a) != 0 ||
-      SDL_RenderClear(renderer_) != 0)
+}
+
+void wall_clock::toggle_stopwatch()
+{
+  if (stopwatch_running_)
+  {
+    stopwatch_elapsed_ = stopwatch_time(stopwatch_state());
+    stopwatch_running_ = false;
+  }
+  else
   {
-    throw std::runtime_error("Clear Background");
+    stopwatch_start_ = std::chrono::steady_clock::now();
+    stopwatch_running_ = true;
   }
-  int space = (height_ - total_height_) / (2 + (weekday_ != "?" ? 1 : 0) + (date_ != "?" ? 1 : 0) + (has_sound_info_ ? 1 : 0));
-  int iX;
-  int iY = space;
-
-  iX = (width_ - size_time_.x - (seconds_ ? size_second_.x : 0) -
-        (time_24_ ? 0 : size_ampm_.x)) /
-       2;
-  render_texture(texture_time_, size_time_, iX, iY);
-  iX += size_time_.x;
-  if (seconds_)
+  plan_rows();
+  if (lines_height_ != calculate_lines_height())
   {
-    render_texture(texture_second_, size_second_, iX, iY);
-    iX += size_second_.x;
+    set_fonts();
   }
-  if (!time_24_)
+  else
   {
-    render_texture(texture_ampm_, size_ampm_, iX,
-                   iY + (size_time_.y - size_ampm_.y) / 2);
-    iX += size_ampm_.x;
+    for (auto &screen : screens_)
+    {
+      plan(*screen);
+    }
   }
-  iY += size_time_.y + space;
-  if (weekday_ != "?")
+  redraw(false);
+}
+
+void wall_clock::lap_stopwatch()
+{
+  if (stopwatch_running_)
   {
-    iX = (width_ - size_weekday_.x) / 2;
-    render_texture(texture_weekday_, size_weekday_, iX, iY);
-    iY += size_weekday_.y + space;
+    auto time = stopwatch_time(stopwatch_state());
+    laps_[lap_count_ % LAP_COUNT] = time - lap_total_;
+    lap_total_ = time;
+    ++lap_count_;
+    publish();
   }
-  if (date_ != "?")
+}
+
+void wall_clock::reset_stopwatch()
+{
+  stopwatch_running_ = false;
+  stopwatch_elapsed_ = std::chrono::steady_clock::duration::zero();
+  lap_count_ = 0;
+  lap_total_ = std::chrono::steady_clock::duration::zero();
+  plan_rows();
+  if (lines_height_ != calculate_lines_height())
   {
-    iX = (width_ - size_date_.x) / 2;
-    render_texture(texture_date_, size_date_, iX, iY);
-    iY += size_date_.y + space;
+    set_fonts();
   }
-  if (has_sound_info_)
+  else
   {
-    iX = (width_ - size_options_.x) / 2;
-    render_texture(texture_options_, size_options_, iX, iY);
-    iY += size_date_.y + space;
+    for (auto &screen : screens_)
+    {
+      plan(*screen);
+    }
   }
-  SDL_RenderPresent(renderer_);
+  redraw(false);
 }
 
-void wall_clock::draw_text(SDL_Texture *&texture, SDL_Point &size,
-                           const std::string &text, TTF_Font *font,
-                           const SDL_Color &color)
+void wall_clock::queue_timer_bells(TIMER &timer)
 {
-  auto surface = TTF_RenderText_Solid(font, text.c_str(), color);
-  if (!surface)
+  SDL_LockAudioDevice(audio_device_);
+  auto position = audio_position();
+  auto horizon = position + std::int64_t(TIMER_HORIZON) * sample_rate_;
+  for (;;)
   {
-    throw std::runtime_error("TTF_RenderText_Solid");
+    auto start = timer.queued < 0
+                     ? timer.origin - 2 * sample_rate_
+                     : timer.origin + std::int64_t(timer.queued) *
+                                          timer_interval_ * sample_rate_;
+    if (start >= horizon)
+    {
+      break;
+    }
+    if (start >= position)
+    {
+      if (timer.queued < 0)
+      {
+        for (int i = 0; i < 3; ++i)
+        {
+          strike(start + i * sample_rate_, get_volume(), 12, timer.tag);
+        }
+        ++timer.queued;
+      }
+      else
+      {
+        strike(start, get_volume(), std::min(12, 2 + timer.queued), timer.tag);
+      }
+    }
+    ++timer.queued;
   }
-  if (texture)
+  SDL_UnlockAudioDevice(audio_device_);
+  SDL_PauseAudioDevice(audio_device_, 0);
+}
+
+void wall_clock::requeue_timer_bells(TIMER &timer)
+{
+  // Bells are queued well ahead with the volume and interval of the time;
+  // those not yet started are queued again with the current ones, spaced by
+  // the new interval from when the timer rang.
+  SDL_LockAudioDevice(audio_device_);
+  auto position = audio_position();
+  strikes_.remove_if(
+      [&](const auto &strike)
+      { return strike.tag == timer.tag && strike.start >= position; });
+  auto interval = std::int64_t(timer_interval_) * sample_rate_;
+  if (position <= timer.origin - 2 * sample_rate_)
   {
-    SDL_DestroyTexture(texture);
+    timer.queued = -1;
   }
-  texture = SDL_CreateTextureFromSurface(renderer_, surface);
-  if (!texture)
+  else if (position <= timer.origin)
   {
-    throw std::runtime_error("SDL_CreateTextureFromSurface");
+    for (int i = 0; i < 3; ++i)
+    {
+      auto start = timer.origin - (2 - i) * sample_rate_;
+      if (start >= position)
+      {
+        strike(start, get_volume(), 12, timer.tag);
+      }
+    }
+    timer.queued = 1;
   }
-  if (SDL_QueryTexture(texture, nullptr, nullptr, &size.x, &size.y) != 0)
+  else
   {
-    throw std::runtime_error("SDL_QueryTexture");
+    timer.queued = int((position - timer.origin + interval - 1) / interval);
   }
-  SDL_FreeSurface(surface);
+  SDL_UnlockAudioDevice(audio_device_);
+  queue_timer_bells(timer);
 }
 
-void wall_clock::render_texture(SDL_Texture *texture, const SDL_Point &size,
-                                const int x, const int y)
+std::int64_t wall_clock::audio_position()
 {
-  SDL_Rect dest{x, y, size.x, size.y};
-  if (SDL_RenderCopy(renderer_, texture, nullptr, &dest) != 0)
-  {
-    throw std::runtime_error("SDL_RenderCopy");
-  }
+  return audio_clock_ +
+         (clock_.steady() - audio_time_) * sample_rate_ /
+             std::chrono::seconds(1);
 }
 
-void wall_clock::start_timer(int delay)
+bool wall_clock::ringing()
 {
-  timer_base_ = frame_time_ + std::chrono::seconds(delay * timer_interval_);
+  return std::any_of(strikes_.begin(), strikes_.end(),
+                     [](const auto &strike)
+                     { return strike.tag == 0; });
 }
 
-void wall_clock::stop_timer()
+void wall_clock::strike(std::int64_t start, float volume, int pitch, int tag)
 {
-  timer_base_ = {};
-  redraw(false);
+  strike(start, volume, &chimes_[pitch], tag);
+}
+
+void wall_clock::strike(std::int64_t start, float volume, const chime *voice,
+                        int tag)
+{
+  strikes_.insert(std::find_if(strikes_.begin(), strikes_.end(),
+                               [&](const auto &strike)
+                               { return strike.start > start; }),
+                  {start, volume, voice, tag});
+}
+
+void wall_clock::cancel(int tag)
+{
+  SDL_LockAudioDevice(audio_device_);
+  auto position = audio_position();
+  strikes_.remove_if([&](auto &strike)
+                     { return strike.tag == tag && strike.start >= position; });
+  SDL_UnlockAudioDevice(audio_device_);
 }
 
 void wall_clock::bell_alarm()
 {
+  trace::span span{"bell_alarm"};
+  auto sequence = take_sequence(alarm_sequence_);
   SDL_LockAudioDevice(audio_device_);
-  if (strikes_.empty())
+  if (!ringing())
+  {
+    log_bell("alarm");
+  }
+  if (!ringing() && sequence)
   {
+    strike(audio_position(), get_volume(), sequence, 0);
+  }
+  else if (!ringing())
+  {
+    auto position = audio_position();
     for (int i = 0; i < 13; ++i)
     {
-      strikes_.push_back(
-          {-int((i * 4.0f + 0.0f) * SEGMENT_COUNT) * SAMPLE_COUNT,
-           get_volume() * (i + 1) / 13.0f, i});
-      strikes_.push_back(
-          {-int((i * 4.0f + 1.0f) * SEGMENT_COUNT) * SAMPLE_COUNT,
-           get_volume() * (i + 1) / 26.0f, i});
+      strike(position + std::int64_t((i * 4.0f + 0.0f) * sample_rate_),
+             get_volume() * (i + 1) / 13.0f, i, 0);
+      strike(position + std::int64_t((i * 4.0f + 1.0f) * sample_rate_),
+             get_volume() * (i + 1) / 26.0f, i, 0);
     }
   }
   SDL_UnlockAudioDevice(audio_device_);
@@ -1185,14 +3797,26 @@ void wall_clock::bell_alarm()
 
 void wall_clock::bell_chime()
 {
+  trace::span span{"bell_chime"};
+  auto sequence = chime_sequence_.due == alarm_scheduler::minute(now_)
+                      ? take_sequence(chime_sequence_)
+                      : nullptr;
   SDL_LockAudioDevice(audio_device_);
-  if (strikes_.empty())
+  if (!ringing())
+  {
+    log_bell("chime " + std::to_string(chime_count(now_.tm_hour)));
+  }
+  if (!ringing() && sequence)
+  {
+    strike(audio_position(), get_volume(), sequence, 0);
+  }
+  else if (!ringing())
   {
+    auto position = audio_position();
     for (int i = 0; i < chime_count(now_.tm_hour); ++i)
     {
-      strikes_.push_back(
-          {-int((i * 1.5f + 0.0f) * SEGMENT_COUNT) * SAMPLE_COUNT, get_volume(),
-           pitch_});
+      strike(position + std::int64_t((i * 1.5f + 0.0f) * sample_rate_),
+             get_volume(), pitch_, 0);
     }
   }
   SDL_UnlockAudioDevice(audio_device_);
@@ -1201,25 +3825,42 @@ void wall_clock::bell_chime()
 
 void wall_clock::bell(int count, int pitch, float delay)
 {
+  trace::span span{"bell"};
   SDL_LockAudioDevice(audio_device_);
-  if (strikes_.empty())
+  if (!ringing())
   {
+    log_bell("bell " + std::to_string(count));
+    auto position = audio_position();
     for (int i = 0; i < count; ++i)
     {
-      strikes_.push_back(
-          {-int((i * delay) * SEGMENT_COUNT) * SAMPLE_COUNT, get_volume(),
-           pitch});
+      strike(position + std::int64_t((i * delay) * sample_rate_), get_volume(),
+             pitch, 0);
     }
   }
   SDL_UnlockAudioDevice(audio_device_);
   SDL_PauseAudioDevice(audio_device_, 0);
 }
 
+void wall_clock::log_bell(const std::string &bell)
+{
+  if (clock_.simulated())
+  {
+    std::cout << std::put_time(&now_, "%Y-%m-%d %H:%M:%S") << " " << bell
+              << std::endl;
+  }
+}
+
 void wall_clock::silent()
 {
   SDL_LockAudioDevice(audio_device_);
-  strikes_.remove_if([](auto &strike)
-                     { return strike.pos <= 0; });
+  auto position = audio_position();
+  strikes_.remove_if(
+      [&](auto &strike)
+      {
+        return strike.start >= position &&
+               (strike.tag == 0 ||
+                strike.start < position + std::int64_t(DURATION) * sample_rate_);
+      });
   SDL_UnlockAudioDevice(audio_device_);
 }
 
@@ -1227,17 +3868,46 @@ void wall_clock::test_bell() { bell(2, pitch_, 2.0f); }
 
 void wall_clock::play_chimes(unsigned char *buffer, int length)
 {
+  trace::name_thread("audio");
+  trace::span span{"play_chimes"};
+  auto now = std::chrono::steady_clock::now();
   SDL_memset(buffer, 0, length);
   SDL_LockAudioDevice(audio_device_);
+  int count = length / sizeof(float);
+  auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(double(count) / sample_rate_));
+  if (audio_idle_)
+  {
+    audio_clock_ = audio_position();
+    audio_idle_ = false;
+  }
+  else if (audio_stats_.callbacks != 0 &&
+           now - audio_stats_.last > period * 3 / 2)
+  {
+    ++audio_stats_.underruns;
+    metrics_.audio_underruns.add();
+  }
+  int voices = 0;
   if (strikes_.empty())
+  {
     SDL_PauseAudioDevice(audio_device_, 1);
+    audio_idle_ = true;
+  }
   else
   {
-    for (auto it = strikes_.begin(); it != strikes_.end();)
+    auto end = audio_clock_ + count;
+    for (auto it = strikes_.begin(); it != strikes_.end() && it->start < end;)
     {
-      if (chimes_[it->pitch].play(it->volume / 1.7f, it->pos,
-                                  reinterpret_cast<float *>(buffer),
-                                  length / sizeof(float)))
+      ++voices;
+      auto offset = it->start - audio_clock_;
+      auto samples = reinterpret_cast<float *>(buffer);
+      if (offset >= 0
+              ? it->voice->play(it->volume / 1.7f, 0, samples + offset,
+                                count - offset)
+              : it->voice->play(
+                    it->volume / 1.7f,
+                    std::min<std::int64_t>(-offset, std::numeric_limits<int>::max()),
+                    samples, count))
       {
         ++it;
       }
@@ -1247,5 +3917,17 @@ void wall_clock::play_chimes(unsigned char *buffer, int length)
       }
     }
   }
+  audio_clock_ += count;
+  audio_time_ = clock_.simulated() ? clock_.steady() : now;
+  auto busy = std::chrono::steady_clock::now() - now;
+  audio_stats_.headroom = audio_stats_.callbacks == 0
+                              ? period - busy
+                              : std::min(audio_stats_.headroom, period - busy);
+  audio_stats_.longest = std::max(audio_stats_.longest, busy);
+  audio_stats_.busy += busy;
+  audio_stats_.last = now;
+  ++audio_stats_.callbacks;
   SDL_UnlockAudioDevice(audio_device_);
+  metrics_.audio_callback.observe(busy);
+  metrics_.audio_voices.set(voices);
 }
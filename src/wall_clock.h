@@ -5,61 +5,332 @@
 #include <SDL_ttf.h>
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "alarm_scheduler.h"
 #include "chime.h"
+#include "chime_bank.h"
+#include "clock_face.h"
+#include "control_socket.h"
+#include "event_log.h"
+#include "font_cache.h"
+#include "glyph_atlas.h"
+#include "metrics.h"
+#include "time_source.h"
+#include "trace.h"
+#include "triple_buffer.h"
+
+#define JUMP_THRESHOLD 2000
+#define TIMER_COUNT 4
+#define LAP_COUNT 8
+#define TIMER_HORIZON 600
+#define PRERENDER_LEAD 5
+#define METRICS_INTERVAL 10
+#define FADE_TIME 1000
+#define TRANSITION_TIME 300
+#define TRANSITION_NONE 0
+#define TRANSITION_SLIDE 1
+#define TRANSITION_FLIP 2
+#define SHIFT_PERIOD_X 1380
+#define SHIFT_PERIOD_Y 1980
+#define ROW_TIME 0
+#define ROW_WEEKDAY 1
+#define ROW_DATE 2
+#define ROW_OPTIONS 3
+#define ROW_STOPWATCH 4
+#define ALIGN_LEFT 0
+#define ALIGN_CENTER 1
+#define ALIGN_RIGHT 2
+#define LAYOUT_MARGIN 32
 
 class wall_clock
 {
+public:
+  struct OPTIONS
+  {
+    bool startup_trace;
+    bool all_displays;
+    std::string control_socket;
+    std::string metrics;
+    std::string trace;
+    bool simulate;
+    std::chrono::system_clock::time_point simulate_from;
+    std::chrono::system_clock::time_point simulate_to;
+    std::string record;
+    std::string replay;
+    bool fast;
+  };
+
+private:
   struct STRIKE
   {
-    int pos;
+    std::int64_t start;
     float volume;
-    int pitch;
+    const chime *voice;
+    int tag;
+  };
+
+  struct SEQUENCE
+  {
+    std::int64_t due;
+    std::future<chime> job;
+    std::unique_ptr<chime> voice;
+  };
+
+  struct AUDIO_STATS
+  {
+    std::uint64_t callbacks;
+    std::uint64_t underruns;
+    std::chrono::steady_clock::duration busy;
+    std::chrono::steady_clock::duration longest;
+    std::chrono::steady_clock::duration headroom;
+    std::chrono::steady_clock::time_point last;
+  };
+
+  struct LINE
+  {
+    std::string text;
+    TTF_Font *font;
+    std::shared_ptr<SDL_Surface> surface;
+    SDL_Point size;
+  };
+
+  // A row of the layout and where it goes. The line is aligned to x, so
+  // placing it only takes its width.
+  struct ROW
+  {
+    int kind;
+    int align;
+    int x;
+    int y;
+  };
+
+  // A date or weekday format, split once into literal text and the %
+  // conversions (code 0 is text).
+  struct FIELD
+  {
+    char code;
+    std::string text;
+  };
+
+  struct STOPWATCH
+  {
+    bool running;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration elapsed;
+    std::size_t lap_count;
+    std::chrono::steady_clock::duration lap;
+    bool pad_minute;
+  };
+
+  // A line is either a rasterized surface or, with distance field text, its
+  // text to lay out at a scale of the distance atlas.
+  struct PLACEMENT
+  {
+    std::shared_ptr<SDL_Surface> surface;
+    SDL_Rect rect;
+    std::string text;
+    float scale;
+  };
+
+  // A line of digits changing from one text to another of the same length.
+  // While it runs, the placed line is drawn glyph by glyph from the digit
+  // atlas instead.
+  struct TRANSITION
+  {
+    std::string from;
+    std::string to;
+    std::chrono::steady_clock::time_point start;
+    std::size_t line;
+  };
+
+  // Everything the render thread needs to draw one frame. Once published it
+  // is never changed; surfaces are shared with later frames that reuse them.
+  struct FRAME
+  {
+    int width;
+    int height;
+    int display;
+    bool fullscreen;
+    bool hide_cursor;
+    SDL_Color background;
+    SDL_Color text_color;
+    Uint8 alpha;
+    SDL_Point shift;
+    std::vector<PLACEMENT> lines;
+    std::shared_ptr<const glyph_atlas> atlas;
+    bool has_stopwatch;
+    STOPWATCH stopwatch;
+    int stopwatch_x;
+    int stopwatch_y;
+    int stopwatch_align;
+    float stopwatch_scale;
+    int transition;
+    std::shared_ptr<const glyph_atlas> digits;
+    std::vector<TRANSITION> transitions;
+    std::shared_ptr<const glyph_atlas> distance;
+    std::shared_ptr<const clock_face> face;
+    float face_time;
+    bool second_hand;
+    bool sweep;
+    std::chrono::steady_clock::time_point requested;
+    std::chrono::steady_clock::time_point tick;
+  };
+
+  // One window and what is laid out in it. The window members belong to the
+  // render thread and the layout members to the control thread; window_id
+  // and display are fixed when the screen is created. hidden and suspended
+  // are the two threads' views of whether the window can be seen.
+  struct SCREEN
+  {
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    Uint32 window_id;
+    int display;
+    FRAME frame;
+    std::vector<std::pair<SDL_Surface *, SDL_Texture *>> textures;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    SDL_Texture *dial;
+    std::shared_ptr<const clock_face> dial_face;
+    std::array<SDL_Texture *, 2> text;
+    SDL_Point text_size;
+    SDL_Point window_size;
+    std::chrono::steady_clock::time_point present_time;
+    int frame_interval;
+    bool hidden;
+    float fade_from;
+    std::chrono::steady_clock::time_point fade_start;
+    std::chrono::steady_clock::time_point presented_request;
+    std::chrono::steady_clock::time_point presented_tick;
+
+    int width;
+    int height;
+    TTF_Font *font_big;
+    TTF_Font *font_medium;
+    TTF_Font *font_small;
+    float scale_big;
+    float scale_medium;
+    float scale_small;
+    int digit_width;
+    int colon_width;
+    int ampm_width;
+    int time_width;
+    LINE line_second;
+    LINE line_time;
+    LINE line_ampm;
+    LINE line_weekday;
+    LINE line_date;
+    LINE line_options;
+    LINE line_debug;
+    std::shared_ptr<const glyph_atlas> atlas_medium;
+    std::shared_ptr<const glyph_atlas> atlas_big;
+    TRANSITION transition_time;
+    TRANSITION transition_second;
+    TTF_Font *font_dial;
+    std::shared_ptr<const clock_face> face;
+    std::vector<ROW> plan;
+    bool suspended;
+  };
+
+  struct TIMER
+  {
+    std::string name;
+    std::chrono::system_clock::time_point base;
+    int tag;
+    std::int64_t origin;
+    int queued;
   };
 
 private:
   const std::string help_path_;
+  const OPTIONS options_;
+  metrics metrics_;
+  time_source clock_;
+  bool started_;
+  std::chrono::steady_clock::time_point stage_time_;
+  std::vector<std::pair<const char *, std::chrono::steady_clock::duration>>
+      stages_;
+  std::future<std::vector<chime>> chime_bank_;
   std::chrono::system_clock::time_point frame_time_;
-  std::chrono::system_clock::time_point timer_base_;
+  std::vector<TIMER> timers_;
+  std::size_t current_timer_;
+  int timer_serial_;
+  bool stopwatch_running_;
+  std::chrono::steady_clock::time_point stopwatch_start_;
+  std::chrono::steady_clock::duration stopwatch_elapsed_;
+  std::array<std::chrono::steady_clock::duration, LAP_COUNT> laps_;
+  std::chrono::steady_clock::duration lap_total_;
+  std::size_t lap_count_;
+  std::chrono::steady_clock::time_point steady_time_;
+  std::chrono::system_clock::time_point wall_reference_;
+  std::chrono::steady_clock::time_point steady_reference_;
   std::tm now_;
 
-  SDL_Window *wnd_;
-  SDL_Renderer *renderer_;
-  SDL_RWops *font_source_;
-  TTF_Font *font_big_;
-  TTF_Font *font_medium_;
-  TTF_Font *font_small_;
-  SDL_Texture *texture_second_;
-  SDL_Point size_second_;
-  SDL_Texture *texture_time_;
-  SDL_Point size_time_;
-  SDL_Texture *texture_ampm_;
-  SDL_Point size_ampm_;
-  SDL_Texture *texture_weekday_;
-  SDL_Point size_weekday_;
-  SDL_Texture *texture_date_;
-  SDL_Point size_date_;
-  SDL_Texture *texture_options_;
-  SDL_Point size_options_;
-  int total_height_;
-  int width_;
-  int height_;
-  int digit_width_;
-  int colon_width_;
-  int ampm_width_;
-  int time_width_;
+  // Render thread: the main thread, which owns the windows and the renderers.
+  // The screens are created up front and never added or removed, and the
+  // frames of all of them are published together.
+  std::vector<std::unique_ptr<SCREEN>> screens_;
+  triple_buffer<std::vector<FRAME>> frames_;
+  Uint32 frame_event_;
+  std::thread control_;
+  std::atomic<bool> running_;
+  std::exception_ptr error_;
+  std::deque<SDL_Event> events_;
+  std::mutex event_mutex_;
+  std::condition_variable event_signal_;
+  Uint32 command_event_;
+  std::unique_ptr<control_socket> socket_;
+  std::atomic<std::int64_t> present_latency_;
+  // Whether every renderer has the blend modes of distance field text; set
+  // with the screens, before the control thread starts.
+  bool distance_blending_;
+
+  // Control thread: events, configuration, scheduling and text.
+  font_cache fonts_;
+  event_log recording_;
+  event_log replay_;
+  std::vector<LINE> prepared_;
+  std::chrono::steady_clock::time_point command_received_;
+  std::chrono::steady_clock::duration command_latency_;
+  std::set<std::size_t> added_alarms_;
+  std::set<std::size_t> removed_alarms_;
   int lines_height_;
+  std::vector<ROW> rows_;
+  std::chrono::steady_clock::time_point suspended_since_;
 
   SDL_AudioDeviceID audio_device_;
+  SDL_AudioSpec audio_spec_;
+  int sample_rate_;
+  int buffer_size_;
+  int chime_rate_;
+  int audio_rate_;
+  int audio_buffer_;
+  std::string font_path_;
+  AUDIO_STATS audio_stats_;
+  std::int64_t audio_clock_;
+  std::chrono::steady_clock::time_point audio_time_;
+  bool audio_idle_;
+  std::vector<chime> bank_;
   std::vector<chime> chimes_;
+  SEQUENCE chime_sequence_;
+  SEQUENCE alarm_sequence_;
   float tense_;
   int pitch_;
   int volume_;
@@ -73,8 +344,23 @@ private:
   bool has_chimes_;
   bool has_alarms_;
   bool has_sound_info_;
+  bool debug_;
+  int transition_;
+  bool analog_;
+  bool sweep_;
+  int pixel_shift_;
+  int max_glyph_size_;
+  bool sdf_;
+  std::shared_ptr<const glyph_atlas> distance_;
+  // The atlas is built in the background from a font of its own; text stays
+  // rasterized until it is done.
+  std::shared_ptr<TTF_Font> distance_font_;
+  std::future<std::shared_ptr<const glyph_atlas>> distance_job_;
   std::string weekday_;
   std::string date_;
+  std::vector<ROW> layout_;
+  std::vector<FIELD> weekday_format_;
+  std::vector<FIELD> date_format_;
   bool time_24_;
   bool seconds_;
   bool pad_hour_;
@@ -84,7 +370,8 @@ private:
   bool pad_month_;
   bool pad_day_;
   int timer_interval_;
-  std::set<std::size_t> alarms_;
+  bool fire_missed_alarms_;
+  alarm_scheduler scheduler_;
   std::size_t next_alarm_;
   std::list<STRIKE> strikes_;
   std::map<std::string, std::function<void(std::istream &)>> config_handlers_;
@@ -124,38 +411,124 @@ private:
   };
 
 public:
-  wall_clock(const std::string &help_path);
+  wall_clock(const std::string &help_path, const OPTIONS &options);
   ~wall_clock();
   void run();
   void play_chimes(unsigned char *buffer, int length);
 
 private:
-  void set_display();
-  void set_window();
+  void start();
+  void simulate();
+  void replay();
+  void record_event(const SDL_Event &event);
+  void mix_audio();
+  void stage(const char *name);
+  void first_frame();
+  void control();
+  bool wait_event(SDL_Event &event,
+                  std::chrono::steady_clock::time_point deadline);
+  void create_screen(int display, bool vsync);
+  SCREEN *find_screen(Uint32 window_id);
+  void forward(const SDL_Event &event);
+  void queue(const SDL_Event &event);
+  bool update_visibility(SCREEN &screen);
+  bool suspended();
+  bool adopt();
+  void adopt(SCREEN &screen, const FRAME &frame);
+  SDL_Texture *texture(const SCREEN &screen, const SDL_Surface *surface);
+  bool resize(SCREEN &screen);
+  bool set_display(SCREEN &screen, int display, bool fullscreen);
+  bool set_window(SCREEN &screen, bool fullscreen);
   void set_fonts();
-  void reset_big_font();
-  void set_big_font();
+  void set_fonts(SCREEN &screen);
+  void reset_big_font(SCREEN &screen);
+  void set_big_font(SCREEN &screen);
+  void measure_big_font(SCREEN &screen);
+  TTF_Font *open_font(int size, float &scale);
+  void build_distance(bool font_changed);
+  void take_distance();
   void create_audio();
+  void close_audio();
+  void report_audio(std::ostream &os);
   void set_config_handlers();
-  int calculate_time_width();
+  int calculate_time_width(const SCREEN &screen);
   int calculate_lines_height();
+  void plan_rows();
+  void plan(SCREEN &screen);
   float get_volume();
   int chime_count(int hour);
   const char *ampm(int hour);
   int handle_event(SDL_Event *event);
+  std::string execute(const control_socket::COMMAND &command);
+  std::string state();
+  std::vector<std::size_t> parse_alarm(std::istream &is);
   void tick();
+  void update_tense();
+  static float tense(const std::tm &time);
+  std::string format_time(const std::tm &time);
+  std::string format_second(const std::tm &time);
+  static std::vector<FIELD> compile_format(const std::string &format);
+  std::string format_weekday(const std::tm &time);
+  std::string format_date(const std::tm &time);
+  std::string format_options();
+  void prepare(std::time_t next);
+  void detect_jump();
+  void check_alarms();
+  void update_alarm_lead();
+  void prepare_sequences(std::int64_t minute);
+  const chime *take_sequence(SEQUENCE &sequence);
+  void release_sequence(SEQUENCE &sequence);
   void read_config();
   void redraw(const bool second_only);
-  void draw_text(SDL_Texture *&texture, SDL_Point &size,
-                 const std::string &text, TTF_Font *font,
-                 const SDL_Color &color);
-  void render_texture(SDL_Texture *texture, const SDL_Point &size, const int x,
-                      const int y);
+  FRAME &begin_frame(const SCREEN &screen, FRAME &frame);
+  void publish();
+  void place_lines(const SCREEN &screen, FRAME &frame);
+  void compose(SCREEN &screen);
+  void draw_dial(SCREEN &screen);
+  void draw_distance(SCREEN &screen);
+  static std::array<SDL_BlendMode, 4> distance_blend_modes();
+  void build_face(SCREEN &screen);
+  static float fade(const SCREEN &screen,
+                    std::chrono::steady_clock::time_point now);
+  static bool animated(const SCREEN &screen,
+                       std::chrono::steady_clock::time_point now);
+  static bool transitioning(const TRANSITION &transition,
+                            std::chrono::steady_clock::time_point now);
+  void animate(SCREEN &screen, const TRANSITION &transition,
+               const SDL_Color &color,
+               std::chrono::steady_clock::time_point now);
+  void draw_digits(SCREEN &screen, LINE &line, TRANSITION &transition,
+                   const std::string &text);
+  void draw_text(LINE &line, const std::string &text, TTF_Font *font,
+                 float scale);
+  void rasterize(LINE &line, const std::string &text, TTF_Font *font);
+  void forget_lines(SCREEN &screen);
+  bool has_date_line();
   void start_timer(int delay);
+  void start_timer(const std::string &name, int delay);
+  void new_timer();
   void stop_timer();
+  void stop_timer(const std::string &name);
+  bool has_stopwatch();
+  STOPWATCH stopwatch_state();
+  static std::chrono::steady_clock::duration
+  stopwatch_time(const STOPWATCH &stopwatch);
+  static void format_stopwatch(const STOPWATCH &stopwatch, char *text,
+                               std::size_t size);
+  void toggle_stopwatch();
+  void lap_stopwatch();
+  void reset_stopwatch();
+  void queue_timer_bells(TIMER &timer);
+  void requeue_timer_bells(TIMER &timer);
+  std::int64_t audio_position();
+  bool ringing();
+  void strike(std::int64_t start, float volume, int pitch, int tag);
+  void strike(std::int64_t start, float volume, const chime *voice, int tag);
+  void cancel(int tag);
   void bell_alarm();
   void bell_chime();
   void bell(int count, int pitch, float delay);
+  void log_bell(const std::string &bell);
   void silent();
   void test_bell();
 };
@@ -0,0 +1,46 @@
+#include "chime.h"
+#include "chime_bank.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Mixes the whole bank into audio-callback sized buffers, as a full alarm
+// does, and reports the time per 1000 buffers and the memory of the waves.
+int main()
+{
+  std::vector<chime> chimes;
+  std::size_t bytes = 0;
+  for (int pitch = 0; pitch < CHIME_BANK_SIZE; ++pitch)
+  {
+    chimes.emplace_back(pitch);
+    bytes += chimes.back().size() * sizeof(sample_t);
+  }
+  std::vector<float> buffer(SAMPLE_COUNT);
+  const int rounds = 20;
+  std::size_t buffers = 0;
+  float sink = 0.0f;
+  auto begin = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round)
+  {
+    for (std::size_t pos = 0; pos < chimes.front().size();
+         pos += SAMPLE_COUNT)
+    {
+      std::fill(buffer.begin(), buffer.end(), 0.0f);
+      for (const auto &voice : chimes)
+      {
+        voice.play(0.5f, pos, buffer.data(), buffer.size());
+      }
+      sink += buffer[pos % SAMPLE_COUNT];
+      ++buffers;
+    }
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  std::printf("%s waves: %.3f ms per 1000 buffers of %d samples, "
+              "%zu chimes, %zu KiB (%g)\n",
+              sizeof(sample_t) == 2 ? "16-bit" : "float",
+              elapsed.count() * 1000 / buffers, SAMPLE_COUNT, chimes.size(),
+              bytes / 1024, sink);
+  return 0;
+}
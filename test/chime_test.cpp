@@ -0,0 +1,84 @@
+#include "chime.h"
+#include "chime_bank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Every chime of the bank, stored as 16-bit samples and played back at full
+// volume, must stay within half a quantization step of its float synthesis,
+// plus the rounding of the float gain. So must a pre-mixed sequence.
+int main()
+{
+  int failures = 0;
+  for (int pitch = 0; pitch < CHIME_BANK_SIZE; ++pitch)
+  {
+    auto wave = chime::synthesize(pitch);
+    chime voice{pitch};
+    std::vector<float> played(voice.size(), 0.0f);
+    voice.play(1.0f, 0, played.data(), played.size());
+    float peak = 0.0f;
+    float error = 0.0f;
+    double noise = 0.0;
+    double signal = 0.0;
+    for (std::size_t i = 0; i < wave.size(); ++i)
+    {
+      auto difference = std::abs(played[i] - wave[i]);
+      peak = std::max(peak, std::abs(wave[i]));
+      error = std::max(error, difference);
+      noise += double(difference) * difference;
+      signal += double(wave[i]) * wave[i];
+    }
+    auto step = peak / 32767.0f;
+    auto bound = step / 2 + peak * 1e-6f;
+    auto snr = 10.0 * std::log10(signal / std::max(noise, 1e-30));
+    std::printf("pitch %2d: peak %.6f error %.3g bound %.3g snr %.1f dB\n",
+                pitch, peak, error, bound, snr);
+    if (voice.size() != wave.size() || error > bound || snr < 80.0)
+    {
+      std::fprintf(stderr, "pitch %d: quantization error out of bound\n",
+                   pitch);
+      ++failures;
+    }
+  }
+  // The alarm ramp, mixed block by block into 16-bit samples, must match
+  // its float mix within half a step as well.
+  std::vector<chime> voices;
+  for (int pitch = 0; pitch < CHIME_BANK_SIZE; ++pitch)
+  {
+    voices.emplace_back(pitch);
+  }
+  std::vector<chime::NOTE> notes;
+  for (int i = 0; i < CHIME_BANK_SIZE; ++i)
+  {
+    notes.push_back({&voices[i], (i + 1) / 13.0f,
+                     std::size_t(i * 4 * SEGMENT_COUNT * SAMPLE_COUNT)});
+    notes.push_back({&voices[i], (i + 1) / 26.0f,
+                     std::size_t((i * 4 + 1) * SEGMENT_COUNT * SAMPLE_COUNT)});
+  }
+  auto sequence = chime::sequence(notes);
+  std::vector<float> mixed(sequence.size(), 0.0f);
+  for (const auto &note : notes)
+  {
+    note.voice->play(note.volume, 0, mixed.data() + note.pos,
+                     note.voice->size());
+  }
+  std::vector<float> played(sequence.size(), 0.0f);
+  sequence.play(1.0f, 0, played.data(), played.size());
+  float peak = 0.0f;
+  float error = 0.0f;
+  for (std::size_t i = 0; i < mixed.size(); ++i)
+  {
+    peak = std::max(peak, std::abs(mixed[i]));
+    error = std::max(error, std::abs(played[i] - mixed[i]));
+  }
+  auto bound = peak / 32767.0f / 2 + peak * 1e-6f;
+  std::printf("alarm sequence: peak %.6f error %.3g bound %.3g\n", peak,
+              error, bound);
+  if (error > bound)
+  {
+    std::fprintf(stderr, "alarm sequence: quantization error out of bound\n");
+    ++failures;
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include "alarm_scheduler.h"
+
+#include <cstdio>
+
+// An alarm every day at 06:30 and 07:00. After the wall clock steps back
+// over them, each must ring again when its minute comes, and none may be
+// reported missed for the minutes before the step.
+int main()
+{
+  int failures = 0;
+  auto check = [&](bool condition, const char *what)
+  {
+    if (!condition)
+    {
+      std::fprintf(stderr, "%s\n", what);
+      ++failures;
+    }
+  };
+  alarm_scheduler scheduler;
+  std::tm day{};
+  day.tm_year = 2026 - 1900;
+  day.tm_mon = 9;
+  day.tm_mday = 19;
+  auto midnight = alarm_scheduler::minute(day);
+  for (int weekday = 0; weekday < 7; ++weekday)
+  {
+    scheduler.add(weekday * 24 * 60 + 6 * 60 + 30);
+    scheduler.add(weekday * 24 * 60 + 7 * 60);
+  }
+  std::size_t missed;
+  bool due;
+  std::size_t rung = 0;
+  for (auto minute = midnight + 6 * 60; minute <= midnight + 8 * 60; ++minute)
+  {
+    check(scheduler.advance(minute, missed, due), "minute not advanced");
+    rung += due;
+  }
+  check(rung == 2, "alarms before the step did not ring");
+  // The clock was an hour and a half fast and is stepped back to 06:30.
+  scheduler.rebase(midnight + 6 * 60 + 30);
+  check(!scheduler.advance(midnight + 6 * 60 + 29, missed, due),
+        "a minute before the step advanced");
+  rung = 0;
+  for (auto minute = midnight + 6 * 60 + 30; minute <= midnight + 8 * 60;
+       ++minute)
+  {
+    check(scheduler.advance(minute, missed, due),
+          "minute after the step not advanced");
+    check(missed == 0, "alarm reported missed after the step");
+    rung += due;
+  }
+  check(rung == 2, "alarms after the step did not ring again");
+  // A step forward leaves the skipped alarms to be reported missed.
+  scheduler.rebase(midnight + 24 * 60 + 8 * 60);
+  check(scheduler.advance(midnight + 24 * 60 + 8 * 60, missed, due) &&
+            missed == 2,
+        "alarms skipped by a step forward not missed");
+  std::printf("%d failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include "resources.h"
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+  struct CANVAS
+  {
+    const char *name;
+    int height;
+  };
+
+  SDL_Surface *render(TTF_Font *font, const std::string &text, bool blended)
+  {
+    auto surface =
+        blended
+            ? TTF_RenderText_Blended(font, text.c_str(), {255, 255, 255, 255})
+            : TTF_RenderText_Solid(font, text.c_str(), {255, 255, 255, 255});
+    if (!surface)
+    {
+      throw std::runtime_error("TTF_RenderText");
+    }
+    return surface;
+  }
+
+  std::size_t texture_bytes(const SDL_Surface *surface)
+  {
+    // Solid text is an 8-bit surface, but the render thread uploads every
+    // line as an ARGB texture.
+    return std::size_t(surface->w) * surface->h * 4;
+  }
+
+  void run(const CANVAS &canvas, int max_glyph_size)
+  {
+    // The time takes four of the nine parts of the default layout.
+    auto size = canvas.height * 4 / 9;
+    auto blended = max_glyph_size && size > max_glyph_size;
+    if (blended)
+    {
+      size = max_glyph_size;
+    }
+    std::size_t uploaded = 0;
+    std::size_t kept = 0;
+    auto begin = std::chrono::steady_clock::now();
+    auto font = TTF_OpenFontRW(
+        SDL_RWFromConstMem(Font_ttf().data, Font_ttf().size), true, size);
+    if (!font)
+    {
+      throw std::runtime_error("TTF_OpenFontRW");
+    }
+    auto time = render(font, "12:34", blended);
+    uploaded += texture_bytes(time);
+    kept += texture_bytes(time);
+    auto first = std::chrono::steady_clock::now();
+    for (int second = 0; second < 60; ++second)
+    {
+      char text[4];
+      std::snprintf(text, sizeof(text), ":%02d", second);
+      auto surface = render(font, text, blended);
+      uploaded += texture_bytes(surface);
+      if (second == 59)
+      {
+        kept += texture_bytes(surface);
+      }
+      SDL_FreeSurface(surface);
+    }
+    auto end = std::chrono::steady_clock::now();
+    SDL_FreeSurface(time);
+    TTF_CloseFont(font);
+    std::chrono::duration<double, std::milli> opening = first - begin;
+    std::chrono::duration<double, std::milli> seconds = end - first;
+    std::printf("%s, max-glyph-size %4d: font %4d px, first %8.3f ms, "
+                "second %7.3f ms, %6zu KiB kept, %7zu KiB uploaded per "
+                "minute\n",
+                canvas.name, max_glyph_size, size, opening.count(),
+                seconds.count() / 60, kept / 1024, uploaded / 1024);
+  }
+}
+
+// Rasterizes the time line of the default layout for a minute at 4K and 8K,
+// with and without max-glyph-size, the way the clock does: solid text at
+// full size, blended text at the cap. Reports the time to open the font and
+// draw the first second, the time per later second, and the bytes of the
+// textures kept and uploaded per minute. The renderer scaling
+// the capped textures up is not included.
+int main(int, char *[])
+{
+  if (TTF_Init() < 0)
+  {
+    throw std::runtime_error("TTF_Init");
+  }
+  // Results are only comparable with the same libraries and build.
+#ifdef NDEBUG
+  const char *build = "release";
+#else
+  const char *build = "debug";
+#endif
+  SDL_version sdl;
+  SDL_GetVersion(&sdl);
+  auto ttf = TTF_Linked_Version();
+  std::printf("SDL %d.%d.%d, SDL_ttf %d.%d.%d, %s build\n", sdl.major,
+              sdl.minor, sdl.patch, ttf->major, ttf->minor, ttf->patch, build);
+  for (const auto &canvas :
+       {CANVAS{"3840x2160", 2160}, CANVAS{"7680x4320", 4320}})
+  {
+    for (auto max_glyph_size : {0, 512, 256})
+    {
+      run(canvas, max_glyph_size);
+    }
+  }
+  TTF_Quit();
+  return 0;
+}